@@ -0,0 +1,212 @@
+#include "CommandExecutor.h"
+#include <cstdio>
+
+static void setResult(CommandResult* result, StatusType res)
+{
+    result->m_kind = RESULT_STATUS;
+    result->m_status = res;
+}
+
+static void setResult(CommandResult* result, Output_t<bool> res)
+{
+    result->m_kind = res.is_res() ? RESULT_BOOL : RESULT_STATUS;
+    result->m_status = res.status();
+    result->m_bool = res.ans();
+}
+
+static void setResult(CommandResult* result, Output_t<int> res)
+{
+    result->m_kind = res.is_res() ? RESULT_INT : RESULT_STATUS;
+    result->m_status = res.status();
+    result->m_int = res.ans();
+}
+
+static void setResult(CommandResult* result, Output_t<double> res)
+{
+    result->m_kind = res.is_res() ? RESULT_DOUBLE : RESULT_STATUS;
+    result->m_status = res.status();
+    result->m_double = res.ans();
+}
+
+static void appendLine(std::string* text, const char* line)
+{
+    if (!text->empty())
+        text->push_back('\n');
+    text->append("stats: ");
+    text->append(line);
+}
+
+static void formatStats(const CompanyStats& stats, std::string* text)
+{
+    char line[320];
+    text->clear();
+    snprintf(line, sizeof(line), "customers=%d capacity=%d load_factor=%.3f resizes=%lld max_bucket_height=%d "
+             "avg_bucket_height=%.3f bucket_rotations=%lld", stats.m_customers.m_size, stats.m_customers.m_capacity,
+             stats.m_customers.m_loadFactor, stats.m_customers.m_resizes, stats.m_customers.m_maxBucketHeight,
+             stats.m_customers.m_avgBucketHeight, stats.m_customers.m_rotations);
+    appendLine(text, line);
+    const CacheStats& cache = stats.m_customerCache;
+    long long cacheLookups = cache.m_hits + cache.m_misses;
+    snprintf(line, sizeof(line), "customer_cache=%d cache_hits=%lld cache_misses=%lld cache_hit_rate=%.3f",
+             cache.m_entries, cache.m_hits, cache.m_misses,
+             cacheLookups == 0 ? 0 : (double) cache.m_hits / cacheLookups);
+    appendLine(text, line);
+    snprintf(line, sizeof(line), "members=%d member_tree_height=%d member_rotations=%lld", stats.m_members,
+             stats.m_memberTreeHeight, stats.m_memberRotations);
+    appendLine(text, line);
+    const FindStats& finds = stats.m_finds;
+    snprintf(line, sizeof(line), "records=%d finds=%lld avg_find_path=%.3f max_find_path=%d p99_find_path=%lld",
+             stats.m_records, finds.m_finds, finds.m_finds == 0 ? 0 : (double) finds.m_steps / finds.m_finds,
+             finds.m_maxPath, finds.m_paths.percentile(0.99));
+    appendLine(text, line);
+    const MemoryUsage& memory = stats.m_memory;
+    snprintf(line, sizeof(line), "memory_bytes=%zu customer_buckets=%zu customer_nodes=%zu customers=%zu member_nodes=%zu "
+             "phone_index=%zu sales=%zu stacks=%zu undo_log=%zu customer_cache=%zu archives=%zu", memory.total(),
+             memory.m_customerBuckets, memory.m_customerNodes, memory.m_customers, memory.m_memberNodes,
+             memory.m_phoneIndex, memory.m_sales, memory.m_stacks, memory.m_undoLog, memory.m_customerCache,
+             memory.m_archives);
+    appendLine(text, line);
+    if (!stats.m_enabled) {
+        appendLine(text, "counters disabled, build with -DRC_STATS");
+        return;
+    }
+    for (int op = 0; op < STAT_OP_COUNT; ++op) {
+        const Histogram& latency = stats.m_latency[op];
+        snprintf(line, sizeof(line), "%s count=%lld p50_ns<%lld p99_ns<%lld p999_ns<%lld", companyOpName((CompanyOp) op),
+                 latency.count(), latency.percentile(0.5), latency.percentile(0.99), latency.percentile(0.999));
+        appendLine(text, line);
+    }
+}
+
+void executeCommand(RecordsCompany* company, Command& command, CommandResult* result)
+{
+    const int* args = command.m_args;
+    result->m_op = command.m_op;
+
+    // dispatch operation
+    switch (command.m_op)
+    {
+        case OP_NEW_MONTH:
+            setResult(result, company->newMonth(command.m_stocks.data(), command.m_stocks.size()));
+            break;
+        case OP_ADD_RECORDS:
+            setResult(result, company->addRecords(command.m_stocks.data(), command.m_stocks.size()));
+            break;
+        case OP_ADD_COSTUMER:
+            setResult(result, company->addCostumer(args[0], args[1]));
+            break;
+        case OP_GET_PHONE:
+            setResult(result, company->getPhone(args[0]));
+            break;
+        case OP_MAKE_MEMBER:
+            setResult(result, company->makeMember(args[0]));
+            break;
+        case OP_IS_MEMBER:
+            setResult(result, company->isMember(args[0]));
+            break;
+        case OP_BUY_RECORD:
+            setResult(result, company->buyRecord(args[0], args[1]));
+            break;
+        case OP_ADD_PRIZE:
+            setResult(result, company->addPrizeCents(args[0], args[1], command.m_amount));
+            break;
+        case OP_GET_EXPENSES:
+            setResult(result, company->getExpenses(args[0]));
+            break;
+        case OP_PUT_ON_TOP:
+            setResult(result, company->putOnTop(args[0], args[1]));
+            break;
+        case OP_GET_PLACE:
+            setResult(result, company->getPlace(args[0], &result->m_int, &result->m_height));
+            if (result->m_status == SUCCESS)
+                result->m_kind = RESULT_PLACE;
+            break;
+        case OP_CHECKPOINT:
+            setResult(result, company->checkpoint());
+            break;
+        case OP_ROLLBACK_TO:
+            setResult(result, company->rollbackTo(args[0]));
+            break;
+        case OP_RELEASE_CHECKPOINTS:
+            setResult(result, company->releaseCheckpoints());
+            break;
+        case OP_GET_CUSTOMER_BY_PHONE:
+            setResult(result, company->getCustomerByPhone(args[0]));
+            break;
+        case OP_REMOVE_CUSTOMER:
+            setResult(result, company->removeCustomer(args[0]));
+            break;
+        case OP_REVOKE_MEMBERSHIP:
+            setResult(result, company->revokeMembership(args[0]));
+            break;
+        case OP_STATS:
+            result->m_kind = RESULT_TEXT;
+            formatStats(company->stats(), &result->m_word);
+            break;
+        case OP_UNKNOWN:
+            result->m_kind = RESULT_UNKNOWN;
+            result->m_word = command.m_word;
+            break;
+    }
+}
+
+static const char *StatusTypeStr[] =
+        {
+                "SUCCESS",
+                "ALLOCATION_ERROR",
+                "INVALID_INPUT",
+                "FAILURE",
+                "ALREADY_EXISTS",
+                "DOESNT_EXISTS"
+        };
+
+void printResult(OutputWriter& out, const CommandResult& result)
+{
+    if (result.m_kind == RESULT_UNKNOWN)
+    {
+        out.write("Unknown command: ");
+        out.write(result.m_word);
+        out.newLine();
+        return;
+    }
+
+    if (result.m_kind == RESULT_TEXT)
+    {
+        out.write(result.m_word);
+        out.newLine();
+        return;
+    }
+
+    out.write(opCodeName(result.m_op));
+    switch (result.m_kind)
+    {
+        case RESULT_STATUS:
+            out.write(": ");
+            out.write(StatusTypeStr[(int) result.m_status]);
+            break;
+        case RESULT_INT:
+            out.write(": ");
+            out.writeInt(result.m_int);
+            break;
+        case RESULT_BOOL:
+            if (result.m_bool)
+                out.write(": True");
+            else
+                out.write(": False");
+            break;
+        case RESULT_DOUBLE:
+            out.write(": ");
+            out.writeDouble(result.m_double);
+            break;
+        case RESULT_PLACE:
+            out.write(": column=");
+            out.writeInt(result.m_int);
+            out.write(", hight=");
+            out.writeInt(result.m_height);
+            break;
+        case RESULT_TEXT:
+        case RESULT_UNKNOWN:
+            break;
+    }
+    out.newLine();
+}
@@ -0,0 +1,38 @@
+#ifndef WET2_COMMANDEXECUTOR_H
+#define WET2_COMMANDEXECUTOR_H
+
+#include "recordsCompany.h"
+#include "CommandParser.h"
+#include "OutputWriter.h"
+#include <string>
+
+typedef enum ResultKind_t {
+    RESULT_STATUS,
+    RESULT_INT,
+    RESULT_BOOL,
+    RESULT_DOUBLE,
+    RESULT_PLACE,
+    RESULT_TEXT,
+    RESULT_UNKNOWN
+} ResultKind;
+
+//what a command returned, kept apart from the formatting so the two can run on different threads
+class CommandResult {
+public:
+    OpCode m_op;
+    ResultKind m_kind;
+    StatusType m_status;
+    bool m_bool;
+    int m_int;
+    //getPlace height, m_int holds the column
+    int m_height;
+    double m_double;
+    //the word read for an unknown command, or the preformatted lines of a text result
+    std::string m_word;
+};
+
+void executeCommand(RecordsCompany* company, Command& command, CommandResult* result);
+void printResult(OutputWriter& out, const CommandResult& result);
+
+
+#endif //WET2_COMMANDEXECUTOR_H
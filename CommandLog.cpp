@@ -0,0 +1,360 @@
+#include "CommandLog.h"
+
+static const char COMMAND_LOG_MAGIC[8] = {'R', 'C', 'L', 'O', 'G', '0', '0', '1'};
+
+static int operandCount(OpCode op)
+{
+    switch (op) {
+        case OP_GET_PHONE:
+        case OP_MAKE_MEMBER:
+        case OP_IS_MEMBER:
+        case OP_GET_EXPENSES:
+        case OP_GET_PLACE:
+        case OP_ROLLBACK_TO:
+        case OP_GET_CUSTOMER_BY_PHONE:
+        case OP_REMOVE_CUSTOMER:
+        case OP_REVOKE_MEMBERSHIP:
+            return 1;
+        case OP_ADD_COSTUMER:
+        case OP_BUY_RECORD:
+        case OP_PUT_ON_TOP:
+        case OP_ADD_PRIZE:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+static bool hasStocks(OpCode op)
+{
+    return op == OP_NEW_MONTH || op == OP_ADD_RECORDS;
+}
+
+CommandLogWriter::CommandLogWriter(FILE* output) : m_output(output), m_buffer(new uint8_t[BUFFER_SIZE]), m_size(0),
+                                                    m_flushed(0)
+{}
+
+CommandLogWriter::~CommandLogWriter()
+{
+    flush();
+    delete[] m_buffer;
+}
+
+void CommandLogWriter::flush()
+{
+    if (m_size > 0)
+        fwrite(m_buffer, 1, m_size, m_output);
+    m_flushed += m_size;
+    m_size = 0;
+    fflush(m_output);
+}
+
+long long CommandLogWriter::size() const
+{
+    return m_flushed + m_size;
+}
+
+void CommandLogWriter::reserve(int length)
+{
+    if (m_size + length > BUFFER_SIZE) {
+        fwrite(m_buffer, 1, m_size, m_output);
+        m_flushed += m_size;
+        m_size = 0;
+    }
+}
+
+void CommandLogWriter::writeVarint(int64_t value)
+{
+    uint64_t zigzag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+    while (zigzag >= 0x80) {
+        m_buffer[m_size++] = (uint8_t) (zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    m_buffer[m_size++] = (uint8_t) zigzag;
+}
+
+void CommandLogWriter::writeStocks(const int* stocks, int count)
+{
+    writeVarint(count);
+    for (int i = 0; i < count; ++i) {
+        reserve(MAX_COMMAND_LENGTH);
+        writeVarint(stocks[i]);
+    }
+}
+
+void CommandLogWriter::append(const Command& command)
+{
+    reserve(MAX_COMMAND_LENGTH);
+    m_buffer[m_size++] = (uint8_t) command.m_op;
+    for (int i = 0; i < operandCount(command.m_op); ++i) {
+        writeVarint(command.m_args[i]);
+    }
+    if (command.m_op == OP_ADD_PRIZE)
+        writeVarint(command.m_amount);
+    if (hasStocks(command.m_op))
+        writeStocks(command.m_stocks.data(), command.m_stocks.size());
+    if (command.m_op == OP_UNKNOWN) {
+        writeVarint(command.m_word.size());
+        for (char c : command.m_word) {
+            reserve(1);
+            m_buffer[m_size++] = (uint8_t) c;
+        }
+    }
+}
+
+void CommandLogWriter::appendStocks(OpCode op, const int* stocks, int count)
+{
+    reserve(MAX_COMMAND_LENGTH);
+    m_buffer[m_size++] = (uint8_t) op;
+    writeStocks(stocks, count);
+}
+
+CommandLogReader::CommandLogReader(FILE* input) : m_input(input), m_buffer(new uint8_t[BUFFER_SIZE]), m_position(0),
+                                                  m_end(0), m_failed(false), m_read(0), m_consumed(0)
+{}
+
+CommandLogReader::~CommandLogReader()
+{
+    delete[] m_buffer;
+}
+
+bool CommandLogReader::failed() const
+{
+    return m_failed;
+}
+
+long long CommandLogReader::consumed() const
+{
+    return m_consumed;
+}
+
+int CommandLogReader::readByte()
+{
+    if (m_position == m_end) {
+        m_end = fread(m_buffer, 1, BUFFER_SIZE, m_input);
+        m_position = 0;
+        if (m_end <= 0) {
+            m_end = 0;
+            return EOF;
+        }
+    }
+    m_read++;
+    return m_buffer[m_position++];
+}
+
+int CommandLogReader::readVarint()
+{
+    uint32_t zigzag = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int byte = readByte();
+        if (byte == EOF) {
+            m_failed = true;
+            return 0;
+        }
+        zigzag |= (uint32_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return (int) ((zigzag >> 1) ^ -(zigzag & 1));
+    }
+    m_failed = true;
+    return 0;
+}
+
+int64_t CommandLogReader::readVarint64()
+{
+    uint64_t zigzag = 0;
+    for (int shift = 0; shift < 70; shift += 7) {
+        int byte = readByte();
+        if (byte == EOF) {
+            m_failed = true;
+            return 0;
+        }
+        zigzag |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return (int64_t) ((zigzag >> 1) ^ -(zigzag & 1));
+    }
+    m_failed = true;
+    return 0;
+}
+
+bool CommandLogReader::next(Command* command)
+{
+    int op = readByte();
+    if (op == EOF || m_failed)
+        return false;
+    if (op > OP_UNKNOWN) {
+        m_failed = true;
+        return false;
+    }
+
+    command->m_op = (OpCode) op;
+    command->m_word = opCodeName(command->m_op);
+    if (command->m_op == OP_UNKNOWN) {
+        command->m_word.clear();
+        int length = readVarint();
+        if (length < 0)
+            m_failed = true;
+        for (int i = 0; i < length && !m_failed; ++i) {
+            int c = readByte();
+            if (c == EOF)
+                m_failed = true;
+            else
+                command->m_word.push_back((char) c);
+        }
+    }
+    for (int i = 0; i < operandCount(command->m_op); ++i) {
+        command->m_args[i] = readVarint();
+    }
+    if (command->m_op == OP_ADD_PRIZE)
+        command->m_amount = readVarint64();
+    if (hasStocks(command->m_op)) {
+        command->m_stocks.clear();
+        int length = readVarint();
+        for (int i = 0; i < length && !m_failed; ++i) {
+            command->m_stocks.push_back(readVarint());
+        }
+    }
+    if (m_failed)
+        return false;
+    m_consumed = m_read;
+    return true;
+}
+
+bool writeCommandLogHeader(FILE* output)
+{
+    return fwrite(COMMAND_LOG_MAGIC, 1, sizeof(COMMAND_LOG_MAGIC), output) == sizeof(COMMAND_LOG_MAGIC);
+}
+
+bool readCommandLogHeader(FILE* input)
+{
+    char magic[sizeof(COMMAND_LOG_MAGIC)];
+    return fread(magic, 1, sizeof(magic), input) == sizeof(magic) &&
+           memcmp(magic, COMMAND_LOG_MAGIC, sizeof(magic)) == 0;
+}
+
+void appendVarint(int64_t value, std::vector<uint8_t>* output)
+{
+    uint64_t zigzag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+    while (zigzag >= 0x80) {
+        output->push_back((uint8_t) (zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    output->push_back((uint8_t) zigzag);
+}
+
+int parseVarint(const uint8_t* data, int size, int* position, int* value)
+{
+    uint32_t zigzag = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*position == size)
+            return 0;
+        uint8_t byte = data[(*position)++];
+        zigzag |= (uint32_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = (int) ((zigzag >> 1) ^ -(zigzag & 1));
+            return 1;
+        }
+    }
+    return -1;
+}
+
+int parseVarint64(const uint8_t* data, int size, int* position, int64_t* value)
+{
+    uint64_t zigzag = 0;
+    for (int shift = 0; shift < 70; shift += 7) {
+        if (*position == size)
+            return 0;
+        uint8_t byte = data[(*position)++];
+        zigzag |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = (int64_t) ((zigzag >> 1) ^ -(zigzag & 1));
+            return 1;
+        }
+    }
+    return -1;
+}
+
+void encodeCommand(const Command& command, std::vector<uint8_t>* output)
+{
+    output->push_back((uint8_t) command.m_op);
+    for (int i = 0; i < operandCount(command.m_op); ++i) {
+        appendVarint(command.m_args[i], output);
+    }
+    if (command.m_op == OP_ADD_PRIZE)
+        appendVarint(command.m_amount, output);
+    if (hasStocks(command.m_op)) {
+        appendVarint(command.m_stocks.size(), output);
+        for (int stock : command.m_stocks) {
+            appendVarint(stock, output);
+        }
+    }
+    if (command.m_op == OP_UNKNOWN) {
+        appendVarint(command.m_word.size(), output);
+        output->insert(output->end(), command.m_word.begin(), command.m_word.end());
+    }
+}
+
+int decodeCommand(const uint8_t* data, int size, Command* command)
+{
+    if (size == 0)
+        return 0;
+    if (data[0] > OP_UNKNOWN)
+        return -1;
+
+    int position = 1;
+    command->m_op = (OpCode) data[0];
+    for (int i = 0; i < operandCount(command->m_op); ++i) {
+        int res = parseVarint(data, size, &position, &command->m_args[i]);
+        if (res != 1)
+            return res;
+    }
+    if (command->m_op == OP_ADD_PRIZE) {
+        int res = parseVarint64(data, size, &position, &command->m_amount);
+        if (res != 1)
+            return res;
+    }
+    if (hasStocks(command->m_op)) {
+        int length;
+        int res = parseVarint(data, size, &position, &length);
+        if (res != 1)
+            return res;
+        //every stock takes at least a byte
+        if (length < 0)
+            return -1;
+        if (length > size - position)
+            return 0;
+        command->m_stocks.resize(length);
+        for (int i = 0; i < length; ++i) {
+            res = parseVarint(data, size, &position, &command->m_stocks[i]);
+            if (res != 1)
+                return res;
+        }
+    }
+    if (command->m_op == OP_UNKNOWN) {
+        int length;
+        int res = parseVarint(data, size, &position, &length);
+        if (res != 1)
+            return res;
+        if (length < 0)
+            return -1;
+        if (length > size - position)
+            return 0;
+        command->m_word.assign((const char*) data + position, length);
+        position += length;
+    }
+    return position;
+}
+
+bool convertTextLog(FILE* text, FILE* binary)
+{
+    if (!writeCommandLogHeader(binary))
+        return false;
+    CommandScanner scanner(text);
+    CommandLogWriter writer(binary);
+    Command command;
+    while (scanner.next(&command)) {
+        writer.append(command);
+        if (command.m_op == OP_UNKNOWN || scanner.failed())
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef WET2_COMMANDLOG_H
+#define WET2_COMMANDLOG_H
+
+#include "CommandParser.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+ * Compact binary encoding of a command stream:
+ * one opcode byte, then every operand as a zigzag varint.
+ * newMonth / addRecords stocks are written as a varint count followed by the stocks,
+ * the addPrize amount in cents as a 64 bit zigzag varint.
+ * An unknown command keeps its word, as a varint length and the characters.
+ */
+class CommandLogWriter {
+public:
+    explicit CommandLogWriter(FILE* output);
+    ~CommandLogWriter();
+    CommandLogWriter(const CommandLogWriter& other) = delete;
+    CommandLogWriter& operator=(const CommandLogWriter& other) = delete;
+    void append(const Command& command);
+    //appends a newMonth or addRecords command straight from the stocks, without building a Command
+    void appendStocks(OpCode op, const int* stocks, int count);
+    //hands the buffered bytes to the FILE, it's up to the caller to sync it
+    void flush();
+    //bytes appended so far, flushed or not
+    long long size() const;
+private:
+    static const int BUFFER_SIZE = 1 << 16;
+    //opcode, two operands and an amount
+    static const int MAX_COMMAND_LENGTH = 1 + 2 * 5 + 10;
+    FILE* m_output;
+    uint8_t* m_buffer;
+    int m_size;
+    long long m_flushed;
+
+    void reserve(int length);
+    void writeVarint(int64_t value);
+    void writeStocks(const int* stocks, int count);
+};
+
+class CommandLogReader {
+public:
+    explicit CommandLogReader(FILE* input);
+    ~CommandLogReader();
+    CommandLogReader(const CommandLogReader& other) = delete;
+    CommandLogReader& operator=(const CommandLogReader& other) = delete;
+    //false at the end of the log or on a malformed command
+    bool next(Command* command);
+    //true if the log ended in the middle of a command or had an unknown opcode
+    bool failed() const;
+    //bytes of the complete commands read so far
+    long long consumed() const;
+private:
+    static const int BUFFER_SIZE = 1 << 20;
+    FILE* m_input;
+    uint8_t* m_buffer;
+    int m_position;
+    int m_end;
+    bool m_failed;
+    long long m_read;
+    long long m_consumed;
+
+    int readByte();
+    int readVarint();
+    int64_t readVarint64();
+};
+
+/*
+ * Standalone log files start with a magic and version, the write-ahead log has its own header.
+ * Logs written before the header existed encoded the addPrize amount differently and are rejected.
+ */
+bool writeCommandLogHeader(FILE* output);
+bool readCommandLogHeader(FILE* input);
+
+/*
+ * The same encoding on memory buffers, for streams that arrive in pieces.
+ * decodeCommand returns the bytes the command took, 0 if the buffer ends
+ * in the middle of it and -1 if it's malformed.
+ */
+void encodeCommand(const Command& command, std::vector<uint8_t>* output);
+int decodeCommand(const uint8_t* data, int size, Command* command);
+//an int takes the same bytes as an int64_t of the same value
+void appendVarint(int64_t value, std::vector<uint8_t>* output);
+//advances *position past the varint, same return values as decodeCommand
+int parseVarint(const uint8_t* data, int size, int* position, int* value);
+int parseVarint64(const uint8_t* data, int size, int* position, int64_t* value);
+
+/*
+ * Converts the driver's text format into a log with a header. The log holds exactly the commands the driver
+ * executes: it stops after an unknown command, and after a command with a malformed operand, which is kept
+ * with the value the driver ran it with. The driver's "Invalid input format" line has no command to hold it,
+ * so that case returns false instead, as does an unknown command.
+ */
+bool convertTextLog(FILE* text, FILE* binary);
+
+
+#endif //WET2_COMMANDLOG_H
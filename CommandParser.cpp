@@ -0,0 +1,276 @@
+#include "CommandParser.h"
+#include <climits>
+#include <cstring>
+
+static const char* OpCodeStr[] =
+        {
+                "newMonth",
+                "addRecords",
+                "addCostumer",
+                "getPhone",
+                "makeMember",
+                "isMember",
+                "buyRecord",
+                "addPrize",
+                "getExpenses",
+                "putOnTop",
+                "getPlace",
+                "stats",
+                "checkpoint",
+                "rollbackTo",
+                "releaseCheckpoints",
+                "getCustomerByPhone",
+                "removeCustomer",
+                "revokeMembership",
+                "unknown"
+        };
+
+const char* opCodeName(OpCode op)
+{
+    return OpCodeStr[(int) op];
+}
+
+static OpCode match(const char* word, int length, OpCode candidate)
+{
+    return memcmp(word, OpCodeStr[(int) candidate], length) == 0 ? candidate : OP_UNKNOWN;
+}
+
+//the length and one character are enough to tell the commands apart, memcmp confirms the guess
+OpCode decodeOpCode(const char* word, int length)
+{
+    switch (length) {
+        case 5:
+            return match(word, length, OP_STATS);
+        case 8:
+            switch (word[0]) {
+                case 'n': return match(word, length, OP_NEW_MONTH);
+                case 'i': return match(word, length, OP_IS_MEMBER);
+                case 'a': return match(word, length, OP_ADD_PRIZE);
+                case 'p': return match(word, length, OP_PUT_ON_TOP);
+                case 'g': return match(word, length, word[4] == 'h' ? OP_GET_PHONE : OP_GET_PLACE);
+                default: return OP_UNKNOWN;
+            }
+        case 9:
+            return match(word, length, OP_BUY_RECORD);
+        case 10:
+            switch (word[0]) {
+                case 'a': return match(word, length, OP_ADD_RECORDS);
+                case 'm': return match(word, length, OP_MAKE_MEMBER);
+                case 'c': return match(word, length, OP_CHECKPOINT);
+                case 'r': return match(word, length, OP_ROLLBACK_TO);
+                default: return OP_UNKNOWN;
+            }
+        case 11:
+            return match(word, length, word[0] == 'a' ? OP_ADD_COSTUMER : OP_GET_EXPENSES);
+        case 14:
+            return match(word, length, OP_REMOVE_CUSTOMER);
+        case 16:
+            return match(word, length, OP_REVOKE_MEMBERSHIP);
+        case 18:
+            return match(word, length, word[0] == 'r' ? OP_RELEASE_CHECKPOINTS : OP_GET_CUSTOMER_BY_PHONE);
+        default:
+            return OP_UNKNOWN;
+    }
+}
+
+CommandScanner::CommandScanner(FILE* input) : m_input(input), m_buffer(new char[BUFFER_SIZE]), m_position(0),
+                                              m_end(0), m_failed(false)
+{}
+
+CommandScanner::~CommandScanner()
+{
+    delete[] m_buffer;
+}
+
+bool CommandScanner::failed() const
+{
+    return m_failed;
+}
+
+//next character without consuming it, EOF at the end of the input
+int CommandScanner::peek()
+{
+    if (m_position == m_end) {
+        m_end = fread(m_buffer, 1, BUFFER_SIZE, m_input);
+        m_position = 0;
+        if (m_end <= 0) {
+            m_end = 0;
+            return EOF;
+        }
+    }
+    return (unsigned char) m_buffer[m_position];
+}
+
+static bool isSpace(int c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool CommandScanner::skipSpaces()
+{
+    int c = peek();
+    while (isSpace(c)) {
+        m_position++;
+        c = peek();
+    }
+    return c != EOF;
+}
+
+bool CommandScanner::readWord(std::string* word)
+{
+    word->clear();
+    if (!skipSpaces())
+        return false;
+    for (int c = peek(); c != EOF && !isSpace(c); c = peek()) {
+        word->push_back((char) c);
+        m_position++;
+    }
+    return true;
+}
+
+int CommandScanner::readInt()
+{
+    if (m_failed || !skipSpaces()) {
+        m_failed = true;
+        return 0;
+    }
+
+    bool negative = false;
+    int c = peek();
+    if (c == '-' || c == '+') {
+        negative = c == '-';
+        m_position++;
+        c = peek();
+    }
+    if (c < '0' || c > '9') {
+        m_failed = true;
+        return 0;
+    }
+
+    long long value = 0;
+    for (; c >= '0' && c <= '9'; c = peek()) {
+        if (value <= (long long) INT_MAX + 1)
+            value = value * 10 + (c - '0');
+        m_position++;
+    }
+    if (negative)
+        value = -value;
+    if (value > INT_MAX || value < INT_MIN) {
+        m_failed = true;
+        return value > 0 ? INT_MAX : INT_MIN;
+    }
+    return (int) value;
+}
+
+//"[sign]units[.fraction]", the units in int range like readInt
+Money CommandScanner::readAmount()
+{
+    if (m_failed || !skipSpaces()) {
+        m_failed = true;
+        return 0;
+    }
+
+    bool negative = false;
+    int c = peek();
+    if (c == '-' || c == '+') {
+        negative = c == '-';
+        m_position++;
+        c = peek();
+    }
+
+    bool hasDigits = false;
+    Money units = 0;
+    for (; c >= '0' && c <= '9'; c = peek()) {
+        if (units <= (Money) INT_MAX + 1)
+            units = units * 10 + (c - '0');
+        hasDigits = true;
+        m_position++;
+    }
+    Money cents = 0;
+    if (c == '.') {
+        m_position++;
+        c = peek();
+        //two digits of cents, the third rounds them and the rest are dropped
+        int digits = 0;
+        for (; c >= '0' && c <= '9'; c = peek()) {
+            if (digits < 2)
+                cents = cents * 10 + (c - '0');
+            else if (digits == 2 && c >= '5')
+                cents++;
+            digits++;
+            m_position++;
+        }
+        if (digits == 1)
+            cents *= 10;
+        hasDigits = hasDigits || digits > 0;
+    }
+    if (!hasDigits || units > (negative ? (Money) INT_MAX + 1 : INT_MAX)) {
+        m_failed = true;
+        return 0;
+    }
+    Money amount = units * CENTS_PER_UNIT + cents;
+    return negative ? -amount : amount;
+}
+
+char CommandScanner::readChar()
+{
+    if (m_failed || !skipSpaces()) {
+        m_failed = true;
+        return 0;
+    }
+    return (char) m_buffer[m_position++];
+}
+
+//"<length> ( <stock> ... )"
+void CommandScanner::readStocks(std::vector<int>* stocks)
+{
+    stocks->clear();
+    int length = readInt();
+    readChar();
+    for (int i = 0; i < length && !m_failed; ++i) {
+        stocks->push_back(readInt());
+    }
+    readChar();
+}
+
+bool CommandScanner::next(Command* command)
+{
+    if (!readWord(&command->m_word))
+        return false;
+
+    command->m_op = decodeOpCode(command->m_word.data(), command->m_word.size());
+    switch (command->m_op) {
+        case OP_NEW_MONTH:
+        case OP_ADD_RECORDS:
+            readStocks(&command->m_stocks);
+            break;
+        case OP_GET_PHONE:
+        case OP_MAKE_MEMBER:
+        case OP_IS_MEMBER:
+        case OP_GET_EXPENSES:
+        case OP_GET_PLACE:
+        case OP_ROLLBACK_TO:
+        case OP_GET_CUSTOMER_BY_PHONE:
+        case OP_REMOVE_CUSTOMER:
+        case OP_REVOKE_MEMBERSHIP:
+            command->m_args[0] = readInt();
+            break;
+        case OP_ADD_COSTUMER:
+        case OP_BUY_RECORD:
+        case OP_PUT_ON_TOP:
+            command->m_args[0] = readInt();
+            command->m_args[1] = readInt();
+            break;
+        case OP_ADD_PRIZE:
+            command->m_args[0] = readInt();
+            command->m_args[1] = readInt();
+            command->m_amount = readAmount();
+            break;
+        case OP_STATS:
+        case OP_CHECKPOINT:
+        case OP_RELEASE_CHECKPOINTS:
+        case OP_UNKNOWN:
+            break;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef WET2_COMMANDPARSER_H
+#define WET2_COMMANDPARSER_H
+
+#include "Money.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+typedef enum OpCode_t {
+    OP_NEW_MONTH,
+    OP_ADD_RECORDS,
+    OP_ADD_COSTUMER,
+    OP_GET_PHONE,
+    OP_MAKE_MEMBER,
+    OP_IS_MEMBER,
+    OP_BUY_RECORD,
+    OP_ADD_PRIZE,
+    OP_GET_EXPENSES,
+    OP_PUT_ON_TOP,
+    OP_GET_PLACE,
+    OP_STATS,
+    OP_CHECKPOINT,
+    OP_ROLLBACK_TO,
+    OP_RELEASE_CHECKPOINTS,
+    OP_GET_CUSTOMER_BY_PHONE,
+    OP_REMOVE_CUSTOMER,
+    OP_REVOKE_MEMBERSHIP,
+    OP_UNKNOWN
+} OpCode;
+
+const char* opCodeName(OpCode op);
+OpCode decodeOpCode(const char* word, int length);
+
+class Command {
+public:
+    OpCode m_op;
+    int m_args[2];
+    //addPrize amount in cents
+    Money m_amount;
+    //newMonth / addRecords operands
+    std::vector<int> m_stocks;
+    //the word read for an unknown command
+    std::string m_word;
+};
+
+/*
+ * Reads commands in the driver's text format from a file in large blocks,
+ * with a hand-rolled integer scanner that accepts what operator>> accepts.
+ */
+class CommandScanner {
+public:
+    explicit CommandScanner(FILE* input);
+    ~CommandScanner();
+    CommandScanner(const CommandScanner& other) = delete;
+    CommandScanner& operator=(const CommandScanner& other) = delete;
+    //false when the input has no more commands
+    bool next(Command* command);
+    //true once an operand was missing or malformed, like cin.fail()
+    bool failed() const;
+private:
+    static const int BUFFER_SIZE = 1 << 20;
+    FILE* m_input;
+    char* m_buffer;
+    int m_position;
+    int m_end;
+    bool m_failed;
+
+    int peek();
+    bool skipSpaces();
+    bool readWord(std::string* word);
+    int readInt();
+    //a decimal amount, rounded to the nearest cent with halves away from zero like moneyFromDouble
+    Money readAmount();
+    char readChar();
+    void readStocks(std::vector<int>* stocks);
+};
+
+
+#endif //WET2_COMMANDPARSER_H
@@ -0,0 +1,180 @@
+#include "ConcurrentUnionFind.h"
+#include <new>
+#include <thread>
+
+ConcurrentUnionFind::ConcurrentUnionFind() : m_nodes(nullptr), m_next(nullptr), m_last(nullptr), m_size(0),
+                                             m_tickets(0)
+{}
+
+ConcurrentUnionFind::~ConcurrentUnionFind()
+{
+    delete[] m_nodes;
+    delete[] m_next;
+    delete[] m_last;
+}
+
+uint64_t ConcurrentUnionFind::pack(uint32_t parent, int payload)
+{
+    return (static_cast<uint64_t>(parent) << 32) | static_cast<uint32_t>(payload);
+}
+
+uint32_t ConcurrentUnionFind::parentOf(uint64_t word)
+{
+    return static_cast<uint32_t>(word >> 32) & ~LOCKED;
+}
+
+int ConcurrentUnionFind::payloadOf(uint64_t word)
+{
+    return static_cast<int>(static_cast<uint32_t>(word));
+}
+
+bool ConcurrentUnionFind::isLocked(uint64_t word)
+{
+    return (static_cast<uint32_t>(word >> 32) & LOCKED) != 0;
+}
+
+void ConcurrentUnionFind::init(const int* recordsStocks, int numberOfRecords)
+{
+    reset(numberOfRecords);
+    for (int i = 0; i < numberOfRecords; ++i) {
+        setRecord(i, i, 0, -1);
+        setColumn(i, recordsStocks[i], i);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ConcurrentUnionFind::reset(int numberOfRecords)
+{
+    delete[] m_nodes;
+    delete[] m_next;
+    delete[] m_last;
+    m_nodes = nullptr;
+    m_next = nullptr;
+    m_last = nullptr;
+    m_size = 0;
+    m_nodes = new std::atomic<uint64_t>[numberOfRecords];
+    try {
+        m_next = new int[numberOfRecords];
+        m_last = new int[numberOfRecords];
+    } catch (std::bad_alloc& e) {
+        delete[] m_nodes;
+        delete[] m_next;
+        m_nodes = nullptr;
+        m_next = nullptr;
+        throw;
+    }
+    m_size = numberOfRecords;
+    m_tickets.store(0, std::memory_order_relaxed);
+}
+
+void ConcurrentUnionFind::setRecord(int id, int column, int height, int next)
+{
+    //a bottom record's payload is its column's height, set by setColumn
+    if (id != column)
+        m_nodes[id].store(pack(column, height), std::memory_order_relaxed);
+    m_next[id] = next;
+}
+
+void ConcurrentUnionFind::setColumn(int column, int totalHeight, int last)
+{
+    m_nodes[column].store(pack(column, totalHeight), std::memory_order_relaxed);
+    m_last[column] = last;
+}
+
+int ConcurrentUnionFind::getSize() const
+{
+    return m_size;
+}
+
+int ConcurrentUnionFind::getNext(int id) const
+{
+    return m_next[id];
+}
+
+int ConcurrentUnionFind::getColumnHeight(int column) const
+{
+    return payloadOf(m_nodes[column].load(std::memory_order_acquire));
+}
+
+int ConcurrentUnionFind::getLast(int column) const
+{
+    return m_last[column];
+}
+
+//path halving find, every step moves strictly up the forest so it finishes in a bounded number of steps
+int ConcurrentUnionFind::find(int id, int* relativeHeight)
+{
+    uint32_t cur = id;
+    int sum = 0;
+
+    while (true) {
+        uint64_t word = m_nodes[cur].load(std::memory_order_acquire);
+        uint32_t parent = parentOf(word);
+        if (parent == cur)
+            break;
+
+        uint64_t parentWord = m_nodes[parent].load(std::memory_order_acquire);
+        uint32_t grandParent = parentOf(parentWord);
+        if (grandParent == parent) {
+            sum += payloadOf(word);
+            cur = parent;
+            break;
+        }
+
+        //heights relative to an ancestor never change, so skipping the parent is always valid
+        int skip = payloadOf(word) + payloadOf(parentWord);
+        m_nodes[cur].compare_exchange_weak(word, pack(grandParent, skip), std::memory_order_release,
+                                           std::memory_order_relaxed);
+        sum += skip;
+        cur = grandParent;
+    }
+
+    if (relativeHeight != nullptr)
+        *relativeHeight = sum;
+
+    return cur;
+}
+
+bool ConcurrentUnionFind::unionSets(int id1, int id2, int* ticket)
+{
+    while (true) {
+        uint32_t B = find(id1, nullptr);
+        uint32_t A = find(id2, nullptr);
+        if (B == A)
+            return false;
+
+        //lock the bottom root so its height can't change while B is linked on top of it
+        uint64_t bottom = m_nodes[A].load(std::memory_order_acquire);
+        if (parentOf(bottom) != A || isLocked(bottom) ||
+            !m_nodes[A].compare_exchange_strong(bottom, bottom | (static_cast<uint64_t>(LOCKED) << 32),
+                                                std::memory_order_acquire, std::memory_order_relaxed)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint64_t top = m_nodes[B].load(std::memory_order_acquire);
+        if (parentOf(top) != B || isLocked(top) ||
+            !m_nodes[B].compare_exchange_strong(top, pack(A, payloadOf(bottom)), std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            m_nodes[A].store(bottom, std::memory_order_release);
+            std::this_thread::yield();
+            continue;
+        }
+
+        //B is no longer a root, so nothing else can change its column's links
+        m_next[m_last[A]] = B;
+        m_last[A] = m_last[B];
+        if (ticket != nullptr)
+            *ticket = m_tickets.fetch_add(1, std::memory_order_relaxed);
+        m_nodes[A].store(pack(A, payloadOf(bottom) + payloadOf(top)), std::memory_order_release);
+        return true;
+    }
+}
+
+std::pair<int, int> ConcurrentUnionFind::getPlace(int id)
+{
+    int relativeHeight;
+    int column = find(id, &relativeHeight);
+
+    return std::make_pair(column, relativeHeight);
+}
@@ -0,0 +1,61 @@
+#ifndef WET2_CONCURRENTUNIONFIND_H
+#define WET2_CONCURRENTUNIONFIND_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+/*
+ * Thread-safe variant of UnionFind with the same column / relative height semantics.
+ * Every record is a single 64-bit word: the parent index in the high half and a payload in the low half.
+ * For a root the payload is the total height of its column, otherwise it is the height relative to the parent.
+ * The root of a set is always the bottom record of the column, so a root's own height is 0 and its id is the column.
+ * find / getPlace never block; unionSets links with CAS and briefly locks the bottom root, which also
+ * guards the column's next links and top record.
+ */
+class ConcurrentUnionFind {
+public:
+    ConcurrentUnionFind();
+    ~ConcurrentUnionFind();
+    ConcurrentUnionFind(const ConcurrentUnionFind& other) = delete;
+    ConcurrentUnionFind& operator=(const ConcurrentUnionFind& other) = delete;
+    //not thread-safe, must not run concurrently with other operations
+    void init(const int* recordsStocks, int numberOfRecords);
+    /*
+     * Loading an existing state, not thread-safe either: reset makes numberOfRecords records,
+     * setRecord puts each one in its column at height above the bottom record,
+     * setColumn gives a bottom record its column's total height and top record.
+     */
+    void reset(int numberOfRecords);
+    void setRecord(int id, int column, int height, int next);
+    void setColumn(int column, int totalHeight, int last);
+    int getSize() const;
+    int find(int id, int* relativeHeight);
+    /*
+     * Puts the column of id1 on top of the column of id2. On success *ticket, if given, is the
+     * union's place in a sequential order of all the successful unions that gives the same stacks.
+     */
+    bool unionSets(int id1, int id2, int* ticket = nullptr);
+    std::pair<int, int> getPlace(int id);
+    //meant for after the concurrent phase: next record up the column, -1 for the top one
+    int getNext(int id) const;
+    //total height and top record of a column, by its bottom record
+    int getColumnHeight(int column) const;
+    int getLast(int column) const;
+private:
+    std::atomic<uint64_t>* m_nodes;
+    //next links and top records, written under the bottom root's lock
+    int* m_next;
+    int* m_last;
+    int m_size;
+    std::atomic<int> m_tickets;
+
+    static const uint32_t LOCKED = 0x80000000u;
+    static uint64_t pack(uint32_t parent, int payload);
+    static uint32_t parentOf(uint64_t word);
+    static int payloadOf(uint64_t word);
+    static bool isLocked(uint64_t word);
+};
+
+
+#endif //WET2_CONCURRENTUNIONFIND_H
@@ -4,8 +4,7 @@
 
 #include "Customer.h"
 
-Customer::Customer(int c_id, int phoneNumber) : m_c_id(c_id), m_phoneNumber(phoneNumber), m_isClubMember(false),
-                                                m_monthlyExpenses(0) {}
+Customer::Customer(int phoneNumber) : m_monthlyExpenses(0), m_phoneNumber(phoneNumber), m_isClubMember(false) {}
 
 int Customer::getPhoneNumber() const
 {
@@ -22,15 +21,16 @@ void Customer::makeMember()
     m_isClubMember = true;
 }
 
-void Customer::buyRecord(int t)
+void Customer::revokeMembership()
 {
-    if (m_isClubMember)
-        m_monthlyExpenses += 100 + t;
+    m_isClubMember = false;
+    m_monthlyExpenses = 0;
 }
 
-int Customer::getID() const
+void Customer::buyRecord(int t)
 {
-    return m_c_id;
+    if (m_isClubMember)
+        m_monthlyExpenses += (100 + (Money) t) * CENTS_PER_UNIT;
 }
 
 void Customer::resetExpenses()
@@ -38,7 +38,12 @@ void Customer::resetExpenses()
     m_monthlyExpenses = 0;
 }
 
-double Customer::getExpenses() const
+Money Customer::getExpenses() const
 {
     return m_monthlyExpenses;
 }
+
+void Customer::setExpenses(Money expenses)
+{
+    m_monthlyExpenses = expenses;
+}
@@ -5,24 +5,28 @@
 #ifndef WET2_CUSTOMER_H
 #define WET2_CUSTOMER_H
 
+#include "Money.h"
+
 class Customer {
 public:
-    Customer(int c_id, int phoneNumber);
+    //the id is the key the customer is stored under, it isn't kept twice
+    explicit Customer(int phoneNumber);
     ~Customer() = default;
     const Customer& operator=(const Customer& other) = delete;
     Customer(const Customer& other) = delete;
     int getPhoneNumber() const;
     bool isClubMember() const;
     void makeMember();
+    //only members have expenses, so they go with the membership
+    void revokeMembership();
     void buyRecord(int t);
-    int getID() const;
     void resetExpenses();
-    double getExpenses() const;
+    Money getExpenses() const;
+    void setExpenses(Money expenses);
 private:
-    int m_c_id;
+    Money m_monthlyExpenses;
     int m_phoneNumber;
     bool m_isClubMember;
-    double m_monthlyExpenses;
 };
 
 
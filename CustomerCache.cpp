@@ -0,0 +1,49 @@
+#include "CustomerCache.h"
+
+CustomerCache::CustomerCache() : m_shift(32), m_hits(0), m_misses(0)
+{}
+
+void CustomerCache::resize(int entries)
+{
+    int bits = 0;
+    while (bits < 30 && (1 << bits) < entries) {
+        bits++;
+    }
+    std::vector<Slot> slots;
+    if (entries > 0)
+        slots.assign((size_t) 1 << bits, Slot{-1, nullptr});
+    m_slots.swap(slots);
+    m_shift = 32 - bits;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+void CustomerCache::invalidate(int c_id)
+{
+    if (!enabled())
+        return;
+    Slot& slot = m_slots[index(c_id)];
+    if (slot.m_id == c_id)
+        slot = Slot{-1, nullptr};
+}
+
+void CustomerCache::clear()
+{
+    for (Slot& slot : m_slots) {
+        slot = Slot{-1, nullptr};
+    }
+}
+
+CacheStats CustomerCache::getStats() const
+{
+    CacheStats stats;
+    stats.m_entries = (int) m_slots.size();
+    stats.m_hits = m_hits;
+    stats.m_misses = m_misses;
+    return stats;
+}
+
+size_t CustomerCache::memoryUsage() const
+{
+    return m_slots.capacity() * sizeof(Slot);
+}
@@ -0,0 +1,64 @@
+#ifndef WET2_CUSTOMERCACHE_H
+#define WET2_CUSTOMERCACHE_H
+
+#include "Customer.h"
+#include "Stats.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * Direct-mapped cache of customer ids to customers in front of the customer table, for lookups
+ * that keep hitting the same few thousand customers. An id maps to one slot by Fibonacci hashing
+ * and a miss simply overwrites it. The customers themselves never move, so an entry stays valid
+ * until its customer is removed, which must invalidate it.
+ */
+class CustomerCache {
+public:
+    CustomerCache();
+    //entries is rounded up to a power of two, 0 turns the cache off, the counters restart
+    void resize(int entries);
+    bool enabled() const
+    {
+        return !m_slots.empty();
+    }
+    //nullptr on a miss, the cache must be enabled
+    Customer* find(int c_id)
+    {
+        const Slot& slot = m_slots[index(c_id)];
+        if (slot.m_id == c_id) {
+            m_hits++;
+            return slot.m_customer;
+        }
+        m_misses++;
+        return nullptr;
+    }
+    void insert(int c_id, Customer* customer)
+    {
+        Slot& slot = m_slots[index(c_id)];
+        slot.m_id = c_id;
+        slot.m_customer = customer;
+    }
+    void invalidate(int c_id);
+    void clear();
+    CacheStats getStats() const;
+    size_t memoryUsage() const;
+private:
+    class Slot {
+    public:
+        //-1 while empty, customer ids aren't negative
+        int m_id;
+        Customer* m_customer;
+    };
+    std::vector<Slot> m_slots;
+    //32 minus log2 of the slot count
+    int m_shift;
+    long long m_hits;
+    long long m_misses;
+    size_t index(int c_id) const
+    {
+        return (size_t) ((unsigned int) c_id * 2654435769u) >> m_shift;
+    }
+};
+
+
+#endif //WET2_CUSTOMERCACHE_H
@@ -0,0 +1,52 @@
+#include "CustomerPool.h"
+#include <new>
+
+CustomerPool::CustomerPool() : m_used(CHUNK_SIZE)
+{}
+
+CustomerPool::~CustomerPool()
+{
+    clear();
+}
+
+Customer* CustomerPool::create(int phoneNumber)
+{
+    if (!m_free.empty()) {
+        Customer* slot = m_free.back();
+        m_free.pop_back();
+        return new (slot) Customer(phoneNumber);
+    }
+    if (m_used == CHUNK_SIZE) {
+        m_chunks.reserve(m_chunks.size() + 1);
+        m_chunks.push_back(static_cast<Customer*>(::operator new(CHUNK_SIZE * sizeof(Customer))));
+        m_used = 0;
+    }
+    return new (m_chunks.back() + m_used++) Customer(phoneNumber);
+}
+
+//without memory for the free list the slot is only reclaimed by clear
+void CustomerPool::release(Customer* customer)
+{
+    if (customer == nullptr)
+        return;
+    try {
+        m_free.push_back(customer);
+    } catch (std::bad_alloc& e) {
+    }
+}
+
+void CustomerPool::clear()
+{
+    for (Customer* chunk : m_chunks) {
+        ::operator delete(chunk);
+    }
+    m_chunks.clear();
+    m_free.clear();
+    m_used = CHUNK_SIZE;
+}
+
+size_t CustomerPool::memoryUsage() const
+{
+    return m_chunks.size() * CHUNK_SIZE * sizeof(Customer) +
+           (m_chunks.capacity() + m_free.capacity()) * sizeof(Customer*);
+}
@@ -0,0 +1,37 @@
+#ifndef WET2_CUSTOMERPOOL_H
+#define WET2_CUSTOMERPOOL_H
+
+#include "Customer.h"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Storage of the customers in the compact configuration (-DRC_COMPACT).
+ * Customers are built in place in fixed chunks and never move, so the customer table and the
+ * member tree hold plain pointers to them instead of a shared_ptr each.
+ * Released slots are reused by the next create, chunks are freed only by clear.
+ */
+class CustomerPool {
+public:
+    CustomerPool();
+    ~CustomerPool();
+    CustomerPool(const CustomerPool& other) = delete;
+    CustomerPool& operator=(const CustomerPool& other) = delete;
+    Customer* create(int phoneNumber);
+    void release(Customer* customer);
+    //releases every customer at once
+    void clear();
+    size_t memoryUsage() const;
+private:
+    static const int CHUNK_SIZE = 4096;
+    //customers are never destroyed one by one, clear drops whole chunks
+    static_assert(std::is_trivially_destructible<Customer>::value, "Customer must be trivially destructible");
+    std::vector<Customer*> m_chunks;
+    //slots used in the last chunk
+    int m_used;
+    std::vector<Customer*> m_free;
+};
+
+
+#endif //WET2_CUSTOMERPOOL_H
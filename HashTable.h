@@ -8,28 +8,83 @@
 #include <iostream>
 #include "Tree.h"
 
+#if defined(__GNUC__)
+#define RC_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define RC_PREFETCH(address)
+#endif
+
+//keys are hashed by hashKey(key) % capacity, other key types overload hashKey next to their class
+inline int hashKey(int key)
+{
+    return key;
+}
+
+//value of a table that only keeps keys, the empty class leaves the nodes the size of a key and links
+class NoValue {};
+
 //Hash table with avl tree collision handling
 template <class K, class V>
 class HashTable {
 public:
     HashTable();
     ~HashTable();
-    void insert(K key, V value);
-    V find(K key);
+    void insert(const K& key, V value);
+    //see Tree::tryEmplace and Tree::emplace
+    template <class... Args>
+    std::pair<V*, bool> tryEmplace(const K& key, Args&&... args);
+    template <class... Args>
+    std::pair<V*, bool> emplace(const K& key, Args&&... args);
+    //the stored value, nullptr if key isn't in the table
+    V* find(const K& key);
+    const V* find(const K& key) const;
+    /*
+     * values[i] = find(keys[i]) for count keys. Works on groups of keys, prefetching all their
+     * buckets and then all their bucket roots, so the cache misses of a group overlap.
+     */
+    void findBatch(const K* keys, int count, V** values);
+    /*
+     * Calls function(key, value) in key order for the keys in [low, high]. Only the bucket of low
+     * is searched, so every key in the range has to hash like low.
+     */
+    template <class Function>
+    void forEachInRange(const K& low, const K& high, Function function) const;
+    //the smallest key not below key in key's bucket, nullptr if there is none, keys hashing like key only
+    const K* lowerBound(const K& key) const;
     void remove(K key);
-    void resetExpenses();
+    TableStats getStats() const;
+    int getSize() const;
+    //bytes of the bucket array and of all the bucket nodes, see Tree::nodeBytes
+    size_t bucketBytes() const;
+    size_t nodeBytes() const;
+    void clear();
+    //makes room for count keys without further resizes
+    void reserve(int count);
+    //calls function(key, value) for every entry, in no particular order
+    template <class Function>
+    void forEach(Function function) const;
 private:
+    static const int BATCH_GROUP = 16;
     int m_size;
     int m_capacity;
     Tree<K, V>* m_table;
-    int hash(K key);
+#ifdef RC_STATS
+    long long m_resizes;
+    //rotations of bucket trees already discarded by resize
+    long long m_retiredRotations;
+#endif
+    int hash(K key) const;
     void deleteTable();
     void resize();
+    void rehash(int capacity);
 };
 
 template<class K, class V>
 HashTable<K, V>::HashTable() : m_size(0), m_capacity(10), m_table(new Tree<K, V>[10])
-{}
+{
+    RC_STATS_ONLY(m_resizes = 0;)
+    RC_STATS_ONLY(m_retiredRotations = 0;)
+}
 
 template<class K, class V>
 HashTable<K, V>::~HashTable()
@@ -44,61 +99,206 @@ void HashTable<K, V>::deleteTable()
 }
 
 template<class K, class V>
-int HashTable<K, V>::hash(K key)
+int HashTable<K, V>::hash(K key) const
+{
+    return hashKey(key) % m_capacity;
+}
+
+template<class K, class V>
+void HashTable<K, V>::insert(const K& key, V value)
 {
-    return key % m_capacity;
+    tryEmplace(key, std::move(value));
 }
 
 template<class K, class V>
-void HashTable<K, V>::insert(K key, V value)
+template<class... Args>
+std::pair<V*, bool> HashTable<K, V>::tryEmplace(const K& key, Args&&... args)
 {
-    if (m_size == m_capacity)
+    if (m_size == m_capacity) {
+        // only a new key may grow the table
+        V* existing = find(key);
+        if (existing != nullptr)
+            return std::pair<V*, bool>(existing, false);
         resize();
+    }
+    int index = hash(key);
+    std::pair<V*, bool> res = m_table[index].tryEmplace(key, std::forward<Args>(args)...);
+    if (res.second)
+        m_size++;
+    return res;
+}
+
+template<class K, class V>
+template<class... Args>
+std::pair<V*, bool> HashTable<K, V>::emplace(const K& key, Args&&... args)
+{
+    V value(std::forward<Args>(args)...);
+    return tryEmplace(key, std::move(value));
+}
+
+template<class K, class V>
+V* HashTable<K, V>::find(const K& key)
+{
     int index = hash(key);
-    m_table[index].insert(key, value);
-    m_size++;
+    Node<K, V>* node = m_table[index].find(key, m_table[index].getRoot());
+    if (node == nullptr)
+        return nullptr;
+    return &node->getValue();
 }
 
 template<class K, class V>
-V HashTable<K, V>::find(K key)
+const V* HashTable<K, V>::find(const K& key) const
 {
     int index = hash(key);
     Node<K, V>* node = m_table[index].find(key, m_table[index].getRoot());
     if (node == nullptr)
         return nullptr;
-    return node->getValue();
+    return &node->getValue();
+}
+
+template<class K, class V>
+void HashTable<K, V>::findBatch(const K* keys, int count, V** values)
+{
+    int indices[BATCH_GROUP];
+    for (int start = 0; start < count; start += BATCH_GROUP)
+    {
+        int size = count - start < BATCH_GROUP ? count - start : BATCH_GROUP;
+        for (int i = 0; i < size; ++i)
+        {
+            indices[i] = hash(keys[start + i]);
+            RC_PREFETCH(&m_table[indices[i]]);
+        }
+        for (int i = 0; i < size; ++i)
+        {
+            RC_PREFETCH(m_table[indices[i]].getRoot());
+        }
+        for (int i = 0; i < size; ++i)
+        {
+            Tree<K, V>& bucket = m_table[indices[i]];
+            Node<K, V>* node = bucket.find(keys[start + i], bucket.getRoot());
+            values[start + i] = node == nullptr ? nullptr : &node->getValue();
+        }
+    }
+}
+
+template<class K, class V>
+template<class Function>
+void HashTable<K, V>::forEachInRange(const K& low, const K& high, Function function) const
+{
+    m_table[hash(low)].forEachInRange(low, high, function);
+}
+
+template<class K, class V>
+const K* HashTable<K, V>::lowerBound(const K& key) const
+{
+    Node<K, V>* node = m_table[hash(key)].lowerBound(key);
+    return node == nullptr ? nullptr : &node->getKey();
 }
 
 template<class K, class V>
 void HashTable<K, V>::remove(K key)
 {
     int index = hash(key);
-    m_table[index].remove(key);
-    m_size--;
+    if (m_table[index].remove(key))
+        m_size--;
 }
 
 template<class K, class V>
 void HashTable<K, V>::resize()
+{
+    rehash(m_capacity * 2);
+}
+
+template<class K, class V>
+void HashTable<K, V>::reserve(int count)
+{
+    if (count > m_capacity)
+        rehash(count);
+}
+
+template<class K, class V>
+int HashTable<K, V>::getSize() const
+{
+    return m_size;
+}
+
+template<class K, class V>
+size_t HashTable<K, V>::bucketBytes() const
+{
+    return m_capacity * sizeof(Tree<K, V>);
+}
+
+template<class K, class V>
+size_t HashTable<K, V>::nodeBytes() const
+{
+    return m_size * sizeof(Node<K, V>);
+}
+
+template<class K, class V>
+void HashTable<K, V>::clear()
+{
+    auto* newTable = new Tree<K, V>[10];
+    deleteTable();
+    m_table = newTable;
+    m_capacity = 10;
+    m_size = 0;
+}
+
+template<class K, class V>
+template<class Function>
+void HashTable<K, V>::forEach(Function function) const
+{
+    for (int i = 0; i < m_capacity; ++i)
+    {
+        m_table[i].forEachInOrder(function);
+    }
+}
+
+//only the new bucket array is allocated, before anything changes, the nodes themselves are relinked
+template<class K, class V>
+void HashTable<K, V>::rehash(int capacity)
 {
     int oldCapacity = m_capacity;
-    m_capacity *= 2;
-    auto hash = [this](K key){return this->hash(key);};
-    auto* newTable = new Tree<K, V>[m_capacity];
+    auto* newTable = new Tree<K, V>[capacity];
+    m_capacity = capacity;
+    auto hash = [this](const K& key){return this->hash(key);};
     for (int i = 0; i < oldCapacity; ++i)
     {
-        m_table[i].inOrder(m_table[i].getRoot(), newTable, hash);
+        RC_STATS_ONLY(m_retiredRotations += m_table[i].getRotations();)
+        m_table[i].moveNodes(newTable, hash);
     }
+    RC_STATS_ONLY(m_resizes++;)
     deleteTable();
     m_table = newTable;
 }
 
+//walks all the buckets, meant for occasional monitoring
 template<class K, class V>
-void HashTable<K, V>::resetExpenses()
+TableStats HashTable<K, V>::getStats() const
 {
+    TableStats stats;
+    stats.m_size = m_size;
+    stats.m_capacity = m_capacity;
+    stats.m_loadFactor = (double) m_size / m_capacity;
+    int nonEmpty = 0;
+    long long heights = 0;
     for (int i = 0; i < m_capacity; ++i)
     {
-        m_table[i].resetExpenses(m_table[i].getRoot());
+        int height = m_table[i].getHeight();
+        stats.m_rotations += m_table[i].getRotations();
+        if (height < 0)
+            continue;
+        nonEmpty++;
+        heights += height;
+        if (height > stats.m_maxBucketHeight)
+            stats.m_maxBucketHeight = height;
     }
+    stats.m_avgBucketHeight = nonEmpty == 0 ? 0 : (double) heights / nonEmpty;
+#ifdef RC_STATS
+    stats.m_resizes = m_resizes;
+    stats.m_rotations += m_retiredRotations;
+#endif
+    return stats;
 }
 
 
@@ -0,0 +1,28 @@
+#ifndef WET2_MONEY_H
+#define WET2_MONEY_H
+
+#include <cmath>
+#include <cstdint>
+
+/*
+ * Expenses and prizes are whole cents in 64 bits, so they add up exactly.
+ * Doubles only appear at the API edges, rounded to the nearest cent.
+ */
+typedef int64_t Money;
+
+const Money CENTS_PER_UNIT = 100;
+//largest amount moneyFromDouble converts, far below the int64 range
+const double MAX_MONEY_AMOUNT = 1e15;
+
+inline Money moneyFromDouble(double amount)
+{
+    return (Money) std::llround(amount * CENTS_PER_UNIT);
+}
+
+inline double moneyToDouble(Money amount)
+{
+    return (double) amount / CENTS_PER_UNIT;
+}
+
+
+#endif //WET2_MONEY_H
@@ -0,0 +1,104 @@
+#include "MonthArchive.h"
+#include "Snapshot.h"
+#include <cstring>
+
+static const char ARCHIVE_MAGIC[8] = {'R', 'C', 'A', 'R', 'C', 'H', '0', '1'};
+
+void MonthArchive::Column::append(int64_t value)
+{
+    appendVarint(value, &m_bytes);
+    m_count++;
+}
+
+bool MonthArchive::Column::valid() const
+{
+    int position = 0;
+    int64_t value;
+    for (int i = 0; i < m_count; ++i) {
+        if (parseVarint64(m_bytes.data(), m_bytes.size(), &position, &value) != 1)
+            return false;
+    }
+    return position == (int) m_bytes.size();
+}
+
+void MonthArchive::appendMember(int c_id, Money expenses)
+{
+    m_ids.append(c_id - m_lastId);
+    m_expenses.append(expenses);
+    m_lastId = c_id;
+}
+
+void MonthArchive::appendSales(int sales)
+{
+    m_sales.append(sales);
+}
+
+int MonthArchive::memberCount() const
+{
+    return m_ids.m_count;
+}
+
+int MonthArchive::recordCount() const
+{
+    return m_sales.m_count;
+}
+
+size_t MonthArchive::byteSize() const
+{
+    return m_ids.m_bytes.size() + m_expenses.m_bytes.size() + m_sales.m_bytes.size();
+}
+
+bool MonthArchive::save(const std::string& path) const
+{
+    SnapshotWriter writer;
+    writer.writeArray(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    for (const Column* column : {&m_ids, &m_expenses, &m_sales}) {
+        writer.write(column->m_count);
+        writer.write((int) column->m_bytes.size());
+        writer.writeArray(column->m_bytes.data(), column->m_bytes.size());
+    }
+    return writeFileAtomically(path, writer.data());
+}
+
+bool MonthArchive::load(const std::string& path)
+{
+    *this = MonthArchive();
+    MappedFile file(path);
+    if (!file.isOpen())
+        return false;
+
+    SnapshotReader reader(file.data(), file.size());
+    char magic[sizeof(ARCHIVE_MAGIC)];
+    if (!reader.readArray(magic, sizeof(magic)) || memcmp(magic, ARCHIVE_MAGIC, sizeof(magic)) != 0)
+        return false;
+    for (Column* column : {&m_ids, &m_expenses, &m_sales}) {
+        int size;
+        if (!reader.read(&column->m_count) || !reader.read(&size) || column->m_count < 0 || size < 0 ||
+            (size_t) size > reader.remaining()) {
+            *this = MonthArchive();
+            return false;
+        }
+        column->m_bytes.resize(size);
+        if (!reader.readArray(column->m_bytes.data(), size) || !column->valid()) {
+            *this = MonthArchive();
+            return false;
+        }
+    }
+    if (!reader.atEnd() || m_ids.m_count != m_expenses.m_count) {
+        *this = MonthArchive();
+        return false;
+    }
+    //ids must ascend
+    bool ascending = true;
+    int previous = -1;
+    scanMembers([&ascending, &previous](int c_id) {
+        ascending = ascending && c_id > previous;
+        previous = c_id;
+    });
+    if (!ascending) {
+        *this = MonthArchive();
+        return false;
+    }
+    m_lastId = previous < 0 ? 0 : previous;
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef WET2_MONTHARCHIVE_H
+#define WET2_MONTHARCHIVE_H
+
+#include "CommandLog.h"
+#include "Money.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef enum ArchiveMode_t {
+    ARCHIVE_OFF,
+    ARCHIVE_MEMORY,
+    //one file per month
+    ARCHIVE_DISK
+} ArchiveMode;
+
+/*
+ * A closed month in columns: the club members' ids, their expenses after prizes and the sales of
+ * every record. A column is a count and one zigzag varint per value, ids stored as the gaps between
+ * ascending ids, so a scan only decodes the columns it reads.
+ * The company fills an archive once and only shares it as const afterwards.
+ */
+class MonthArchive {
+public:
+    MonthArchive() = default;
+    //members come in ascending id order
+    void appendMember(int c_id, Money expenses);
+    //records come in id order
+    void appendSales(int sales);
+    int memberCount() const;
+    int recordCount() const;
+    //bytes of the encoded columns
+    size_t byteSize() const;
+    //function(c_id) for every member, decodes the id column only
+    template <class Function>
+    void scanMembers(Function function) const;
+    //function(c_id, expenses) for every member, decodes the id and expense columns
+    template <class Function>
+    void scanExpenses(Function function) const;
+    //function(r_id, sales) for every record, decodes the sales column only
+    template <class Function>
+    void scanSales(Function function) const;
+    bool save(const std::string& path) const;
+    //false if the file is missing or malformed, the archive is then empty
+    bool load(const std::string& path);
+private:
+    class Column {
+    public:
+        Column() : m_count(0) {}
+        int m_count;
+        std::vector<uint8_t> m_bytes;
+        void append(int64_t value);
+        //true if the bytes are exactly m_count varints
+        bool valid() const;
+    };
+    //reads the values of a column one by one, the column must be valid
+    class ColumnReader {
+    public:
+        explicit ColumnReader(const Column& column) : m_column(column), m_position(0) {}
+        int64_t next()
+        {
+            int64_t value = 0;
+            parseVarint64(m_column.m_bytes.data(), m_column.m_bytes.size(), &m_position, &value);
+            return value;
+        }
+    private:
+        const Column& m_column;
+        int m_position;
+    };
+    Column m_ids;
+    Column m_expenses;
+    Column m_sales;
+    int m_lastId = 0;
+};
+
+template <class Function>
+void MonthArchive::scanMembers(Function function) const
+{
+    ColumnReader ids(m_ids);
+    int c_id = 0;
+    for (int i = 0; i < m_ids.m_count; ++i) {
+        c_id += (int) ids.next();
+        function(c_id);
+    }
+}
+
+template <class Function>
+void MonthArchive::scanExpenses(Function function) const
+{
+    ColumnReader ids(m_ids);
+    ColumnReader expenses(m_expenses);
+    int c_id = 0;
+    for (int i = 0; i < m_ids.m_count; ++i) {
+        c_id += (int) ids.next();
+        function(c_id, (Money) expenses.next());
+    }
+}
+
+template <class Function>
+void MonthArchive::scanSales(Function function) const
+{
+    ColumnReader sales(m_sales);
+    for (int i = 0; i < m_sales.m_count; ++i) {
+        function(i, (int) sales.next());
+    }
+}
+
+
+#endif //WET2_MONTHARCHIVE_H
@@ -5,13 +5,99 @@
 #ifndef WET1_NODE_H
 #define WET1_NODE_H
 
-template <class Key, class Value>
-class Node {
+#include "Money.h"
+#include <utility>
+
+/*
+ * Augmentation policies of Node and Tree. A plain tree is a bare AVL tree, the hash table buckets use it.
+ * A prize tree keeps lazy prize offsets for the club members: a member's prize is the sum of the extras
+ * on the path from the root down to its node. Its values point to objects with getExpenses(), and every
+ * node also keeps the largest expenses minus prize in its subtree.
+ * Each policy has static hooks Tree calls before a rotation, when it attaches a new node, before a removal
+ * moves a node into the removed one's place (spliced, successorTaken) and when a node's children or value
+ * changed (update).
+ */
+class PlainAugment {
+public:
+    template <class NodeType>
+    static void beforeLeftRotation(NodeType*) {}
+    template <class NodeType>
+    static void beforeRightRotation(NodeType*) {}
+    template <class NodeType>
+    static void attached(NodeType*, NodeType*) {}
+    template <class NodeType>
+    static void spliced(NodeType*, NodeType*) {}
+    template <class NodeType>
+    static void successorTaken(NodeType*, NodeType*) {}
+    template <class NodeType>
+    static void update(NodeType*) {}
+};
+
+class PrizeAugment {
+public:
+    template <class NodeType>
+    static void beforeLeftRotation(NodeType* current);
+    template <class NodeType>
+    static void beforeRightRotation(NodeType* current);
+    template <class NodeType>
+    static void attached(NodeType* root, NodeType* node);
+    //node is removed and its only child is about to be copied over it
+    template <class NodeType>
+    static void spliced(NodeType* node, NodeType* child);
+    //node is about to take its successor's key and value, the successor being removed next
+    template <class NodeType>
+    static void successorTaken(NodeType* node, NodeType* successor);
+    template <class NodeType>
+    static void update(NodeType* node);
+};
+
+//fields a policy adds to every node, none for a plain tree so the empty base takes no space
+template <class Augment>
+class NodeAugment {};
+
+template <>
+class NodeAugment<PrizeAugment> {
+public:
+    NodeAugment() : m_extra(0), m_subtreeMax(0) {}
+    Money getExtra() const
+    {
+        return m_extra;
+    }
+    //adds to the extra, the subtree maximum moves with it
+    void setExtra(Money extra)
+    {
+        this->m_extra += extra;
+        this->m_subtreeMax -= extra;
+    }
+    //the maximum is stale until the next update
+    void newMonthNullify()
+    {
+        m_extra = 0;
+    }
+    //largest expenses minus prize in the subtree, not counting the extras above this node
+    Money getSubtreeMax() const
+    {
+        return m_subtreeMax;
+    }
+    void setSubtreeMax(Money subtreeMax)
+    {
+        m_subtreeMax = subtreeMax;
+    }
+
+private:
+    Money m_extra;
+    Money m_subtreeMax;
+};
+
+template <class Key, class Value, class Augment = PlainAugment>
+class Node : public NodeAugment<Augment> {
 public:
     /*
      * Constructors
      */
-    explicit Node(const Key& key, const Value& value);
+    //the value is built from args
+    template <class... Args>
+    explicit Node(const Key& key, Args&&... args);
     /*
      * Default destructor, tree is responsible for deleting nodes
      */
@@ -24,11 +110,10 @@ public:
     const Key& getKey() const;
     const Value& getValue() const;
     Value& getValue();
-    Node<Key,Value>* getLeft() const;
-    Node<Key,Value>* getRight() const;
+    Node<Key, Value, Augment>* getLeft() const;
+    Node<Key, Value, Augment>* getRight() const;
     int getBalanceFactor() const;
     int getHeight() const;
-    int getExtra() const;
     /*
      * Setters
      */
@@ -37,71 +122,53 @@ public:
     void setHeight(int height);
     void setValue(const Value& value);
     void setKey(const Key& key);
-    void setExtra(double extra);
-    void newMonthNullify();
 
 private:
+    //the height fills the padding after an int key
     Key m_key;
-    Value m_value;
-    Node<Key,Value>* m_left;
-    Node<Key,Value>* m_right;
     int m_height;
-    double m_extra;
+    Value m_value;
+    Node<Key, Value, Augment>* m_left;
+    Node<Key, Value, Augment>* m_right;
 };
 
-template<class Key, class Value>
-void Node<Key, Value>::newMonthNullify()
-{
-    m_extra = 0;
-}
-
-template<class Key, class Value>
-int Node<Key, Value>::getExtra() const
-{
-    return m_extra;
-}
-
-template<class Key, class Value>
-void Node<Key, Value>::setExtra(double extra)
-{
-    this->m_extra += extra;
-}
-
-template <class Key, class Value>
-Node<Key, Value>::Node(const Key& key, const Value& value) : m_key(key), m_value(value), m_left(nullptr), m_right(nullptr),
-                                                             m_height(0), m_extra(0) {}
-template <class Key, class Value>
-const Key& Node<Key, Value>::getKey() const
+template <class Key, class Value, class Augment>
+template <class... Args>
+Node<Key, Value, Augment>::Node(const Key& key, Args&&... args) : m_key(key), m_height(0),
+                                                                  m_value(std::forward<Args>(args)...),
+                                                                  m_left(nullptr), m_right(nullptr) {}
+template <class Key, class Value, class Augment>
+const Key& Node<Key, Value, Augment>::getKey() const
 {
     return m_key;
 }
 
-template <class Key, class Value>
-const Value& Node<Key, Value>::getValue() const
+template <class Key, class Value, class Augment>
+const Value& Node<Key, Value, Augment>::getValue() const
 {
     return m_value;
 }
 
-template<class Key, class Value>
-Value& Node<Key, Value>::getValue()
+template <class Key, class Value, class Augment>
+Value& Node<Key, Value, Augment>::getValue()
 {
     return m_value;
 }
 
-template<class Key, class Value>
-Node<Key,Value>* Node<Key, Value>::getRight() const
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Node<Key, Value, Augment>::getRight() const
 {
     return m_right;
 }
 
-template<class Key, class Value>
-Node<Key,Value>* Node<Key, Value>::getLeft() const
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Node<Key, Value, Augment>::getLeft() const
 {
     return m_left;
 }
 
-template<class Key, class Value>
-int Node<Key, Value>::getBalanceFactor() const
+template <class Key, class Value, class Augment>
+int Node<Key, Value, Augment>::getBalanceFactor() const
 {
     int leftHeight, rightHeight;
     if (this->getLeft() == nullptr)
@@ -116,40 +183,113 @@ int Node<Key, Value>::getBalanceFactor() const
     return (leftHeight - rightHeight);
 }
 
-template <class Key, class Value>
-int Node<Key, Value>::getHeight() const
+template <class Key, class Value, class Augment>
+int Node<Key, Value, Augment>::getHeight() const
 {
     return m_height;
 }
 
-template<class Key, class Value>
-void Node<Key, Value>::setRight(Node<Key,Value>* newRight)
+template <class Key, class Value, class Augment>
+void Node<Key, Value, Augment>::setRight(Node<Key, Value, Augment>* newRight)
 {
     this->m_right = newRight;
 }
 
-template<class Key, class Value>
-void Node<Key, Value>::setLeft(Node<Key,Value>* newLeft)
+template <class Key, class Value, class Augment>
+void Node<Key, Value, Augment>::setLeft(Node<Key, Value, Augment>* newLeft)
 {
     this->m_left = newLeft;
 }
 
-template <class Key, class Value>
-void Node<Key, Value>::setHeight(int newHeight)
+template <class Key, class Value, class Augment>
+void Node<Key, Value, Augment>::setHeight(int newHeight)
 {
     this->m_height = newHeight;
 }
 
-template <class Key, class Value>
-void Node<Key, Value>::setValue(const Value& newValue)
+template <class Key, class Value, class Augment>
+void Node<Key, Value, Augment>::setValue(const Value& newValue)
 {
     this->m_value = newValue;
 }
 
-template<class Key, class Value>
-void Node<Key, Value>::setKey(const Key& newKey)
+template <class Key, class Value, class Augment>
+void Node<Key, Value, Augment>::setKey(const Key& newKey)
 {
     this->m_key = newKey;
 }
 
+template <class NodeType>
+void PrizeAugment::beforeLeftRotation(NodeType* current)
+{
+    Money temp = current->getRight()->getExtra();
+    current->getRight()->setExtra(current->getExtra());
+    current->setExtra(-(current->getRight()->getExtra()));
+    if (current->getRight()->getLeft() != nullptr)
+        current->getRight()->getLeft()->setExtra(temp);
+}
+
+template <class NodeType>
+void PrizeAugment::beforeRightRotation(NodeType* current)
+{
+    Money temp = current->getLeft()->getExtra();
+    current->getLeft()->setExtra(current->getExtra());
+    current->setExtra(-(current->getLeft()->getExtra()));
+    if (current->getLeft()->getRight() != nullptr)
+        current->getLeft()->getRight()->setExtra(temp);
+}
+
+// Set the extra field of the new node to be the negative of the sum of the extra values on the path to its parent
+template <class NodeType>
+void PrizeAugment::attached(NodeType* root, NodeType* node)
+{
+    NodeType* temp = root;
+    Money sum = 0;
+    while (temp != nullptr) {
+        sum += temp->getExtra();
+        if (node->getKey() < temp->getKey()) {
+            temp = temp->getLeft();
+        } else if (node->getKey() > temp->getKey()) {
+            temp = temp->getRight();
+        } else {
+            break;
+        }
+    }
+    node->setExtra(-sum);
+}
+
+// The child's subtree keeps its prizes by taking over the removed node's extra as well
+template <class NodeType>
+void PrizeAugment::spliced(NodeType* node, NodeType* child)
+{
+    child->setExtra(node->getExtra());
+}
+
+/*
+ * The successor's value moves up to node, so node's extra grows by the extras between them for the
+ * value to keep its prize. Both children give the same amount back so nothing else below node changes.
+ */
+template <class NodeType>
+void PrizeAugment::successorTaken(NodeType* node, NodeType* successor)
+{
+    Money sum = successor->getExtra();
+    for (NodeType* temp = node->getRight(); temp != successor; temp = temp->getLeft()) {
+        sum += temp->getExtra();
+    }
+    node->setExtra(sum);
+    node->getLeft()->setExtra(-sum);
+    node->getRight()->setExtra(-sum);
+}
+
+template <class NodeType>
+void PrizeAugment::update(NodeType* node)
+{
+    Money best = node->getValue()->getExpenses();
+    if (node->getLeft() != nullptr && node->getLeft()->getSubtreeMax() > best)
+        best = node->getLeft()->getSubtreeMax();
+    if (node->getRight() != nullptr && node->getRight()->getSubtreeMax() > best)
+        best = node->getRight()->getSubtreeMax();
+    node->setSubtreeMax(best - node->getExtra());
+}
+
 #endif //WET1_NODE_H
@@ -0,0 +1,90 @@
+#include "OutputWriter.h"
+#include <cmath>
+#include <cstring>
+
+OutputWriter::OutputWriter(FILE* output) : m_output(output), m_buffer(new char[BUFFER_SIZE]), m_size(0)
+{}
+
+OutputWriter::~OutputWriter()
+{
+    flush();
+    delete[] m_buffer;
+}
+
+void OutputWriter::flush()
+{
+    if (m_size > 0)
+        fwrite(m_buffer, 1, m_size, m_output);
+    m_size = 0;
+    fflush(m_output);
+}
+
+void OutputWriter::reserve(int length)
+{
+    if (m_size + length > BUFFER_SIZE) {
+        fwrite(m_buffer, 1, m_size, m_output);
+        m_size = 0;
+    }
+}
+
+void OutputWriter::write(const char* text, int length)
+{
+    if (length > BUFFER_SIZE) {
+        flush();
+        fwrite(text, 1, length, m_output);
+        return;
+    }
+    reserve(length);
+    memcpy(m_buffer + m_size, text, length);
+    m_size += length;
+}
+
+void OutputWriter::write(const char* text)
+{
+    write(text, strlen(text));
+}
+
+void OutputWriter::write(const std::string& text)
+{
+    write(text.data(), text.size());
+}
+
+void OutputWriter::write(char c)
+{
+    reserve(1);
+    m_buffer[m_size++] = c;
+}
+
+void OutputWriter::newLine()
+{
+    write('\n');
+}
+
+void OutputWriter::writeInt(long long value)
+{
+    reserve(MAX_NUMBER_LENGTH);
+    unsigned long long magnitude = value < 0 ? -(unsigned long long) value : value;
+    char digits[MAX_NUMBER_LENGTH];
+    int length = 0;
+    do {
+        digits[length++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+        m_buffer[m_size++] = '-';
+    while (length > 0) {
+        m_buffer[m_size++] = digits[--length];
+    }
+}
+
+//same as ostream's default "%g" with precision 6, whole numbers below 10^6 skip printf
+void OutputWriter::writeDouble(double value)
+{
+    if (value == std::floor(value) && std::fabs(value) < 1e6 && !(value == 0 && std::signbit(value))) {
+        writeInt((long long) value);
+        return;
+    }
+    reserve(MAX_NUMBER_LENGTH);
+    m_size += snprintf(m_buffer + m_size, MAX_NUMBER_LENGTH, "%g", value);
+}
@@ -0,0 +1,37 @@
+#ifndef WET2_OUTPUTWRITER_H
+#define WET2_OUTPUTWRITER_H
+
+#include <cstdio>
+#include <string>
+
+/*
+ * Formats output into a large reusable buffer and writes it in big chunks.
+ * Numbers are formatted the way std::ostream formats them with default flags.
+ */
+class OutputWriter {
+public:
+    explicit OutputWriter(FILE* output);
+    ~OutputWriter();
+    OutputWriter(const OutputWriter& other) = delete;
+    OutputWriter& operator=(const OutputWriter& other) = delete;
+    void write(const char* text, int length);
+    void write(const char* text);
+    void write(const std::string& text);
+    void write(char c);
+    void writeInt(long long value);
+    void writeDouble(double value);
+    void newLine();
+    void flush();
+private:
+    static const int BUFFER_SIZE = 1 << 20;
+    //the longest single number we format
+    static const int MAX_NUMBER_LENGTH = 32;
+    FILE* m_output;
+    char* m_buffer;
+    int m_size;
+
+    void reserve(int length);
+};
+
+
+#endif //WET2_OUTPUTWRITER_H
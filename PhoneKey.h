@@ -0,0 +1,32 @@
+#ifndef WET2_PHONEKEY_H
+#define WET2_PHONEKEY_H
+
+/*
+ * Key of the phone index. Keys are ordered by phone and then by customer id, and hashKey only
+ * looks at the phone, so the customers sharing a phone are neighbours in one bucket tree.
+ */
+class PhoneKey {
+public:
+    int m_phone;
+    int m_id;
+    bool operator<(const PhoneKey& other) const
+    {
+        return m_phone < other.m_phone || (m_phone == other.m_phone && m_id < other.m_id);
+    }
+    bool operator>(const PhoneKey& other) const
+    {
+        return other < *this;
+    }
+    bool operator==(const PhoneKey& other) const
+    {
+        return m_phone == other.m_phone && m_id == other.m_id;
+    }
+};
+
+inline int hashKey(const PhoneKey& key)
+{
+    return key.m_phone;
+}
+
+
+#endif //WET2_PHONEKEY_H
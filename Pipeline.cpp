@@ -0,0 +1,112 @@
+#include "Pipeline.h"
+#include "CommandExecutor.h"
+#include "SpscRing.h"
+#include <thread>
+
+static const int RING_CAPACITY = 4096;
+
+class PipelineCommand {
+public:
+    Command m_command;
+    //false for the end of input marker
+    bool m_hasCommand;
+    //nothing follows this item
+    bool m_last;
+    bool m_inputFailed;
+};
+
+class PipelineResult {
+public:
+    CommandResult m_result;
+    bool m_hasResult;
+    bool m_last;
+    bool m_inputFailed;
+};
+
+template <class T>
+static T* waitForClaim(SpscRing<T>& ring)
+{
+    T* slot;
+    while ((slot = ring.claim()) == nullptr) {
+        std::this_thread::yield();
+    }
+    return slot;
+}
+
+template <class T>
+static T* waitForFront(SpscRing<T>& ring)
+{
+    T* slot;
+    while ((slot = ring.front()) == nullptr) {
+        std::this_thread::yield();
+    }
+    return slot;
+}
+
+//the sequential driver stops after an unknown command or a malformed operand, so does the parser
+static void parse(FILE* input, SpscRing<PipelineCommand>* commands)
+{
+    CommandScanner scanner(input);
+    while (true) {
+        PipelineCommand* slot = waitForClaim(*commands);
+        slot->m_hasCommand = scanner.next(&slot->m_command);
+        slot->m_inputFailed = slot->m_hasCommand && scanner.failed();
+        slot->m_last = !slot->m_hasCommand || slot->m_inputFailed || slot->m_command.m_op == OP_UNKNOWN;
+        bool last = slot->m_last;
+        commands->publish();
+        if (last)
+            return;
+    }
+}
+
+static void execute(SpscRing<PipelineCommand>* commands, SpscRing<PipelineResult>* results)
+{
+    RecordsCompany *company = new RecordsCompany();
+    while (true) {
+        PipelineCommand* command = waitForFront(*commands);
+        PipelineResult* result = waitForClaim(*results);
+        result->m_hasResult = command->m_hasCommand;
+        if (command->m_hasCommand)
+            executeCommand(company, command->m_command, &result->m_result);
+        result->m_inputFailed = command->m_inputFailed;
+        result->m_last = command->m_last;
+        bool last = command->m_last;
+        results->publish();
+        commands->release();
+        if (last)
+            break;
+    }
+    delete company;
+}
+
+int runPipeline(FILE* input, FILE* output)
+{
+    SpscRing<PipelineCommand> commands(RING_CAPACITY);
+    SpscRing<PipelineResult> results(RING_CAPACITY);
+    std::thread parser(parse, input, &commands);
+    std::thread executor(execute, &commands, &results);
+
+    int exitCode = 0;
+    {
+        OutputWriter out(output);
+        while (true) {
+            PipelineResult* result = waitForFront(results);
+            if (result->m_hasResult)
+                printResult(out, result->m_result);
+            if (result->m_inputFailed) {
+                out.write("Invalid input format ");
+                out.newLine();
+            }
+            bool last = result->m_last;
+            if (result->m_inputFailed || (result->m_hasResult && result->m_result.m_kind == RESULT_UNKNOWN))
+                exitCode = -1;
+            results.release();
+            if (last)
+                break;
+        }
+    }
+
+    parser.join();
+    executor.join();
+    return exitCode;
+}
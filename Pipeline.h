@@ -0,0 +1,15 @@
+#ifndef WET2_PIPELINE_H
+#define WET2_PIPELINE_H
+
+#include <cstdio>
+
+/*
+ * Runs a text command file like the sequential driver, split into three threads:
+ * parsing, executing against RecordsCompany and formatting the output,
+ * connected by single-producer single-consumer rings.
+ * Returns the driver's exit code.
+ */
+int runPipeline(FILE* input, FILE* output);
+
+
+#endif //WET2_PIPELINE_H
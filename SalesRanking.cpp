@@ -0,0 +1,113 @@
+#include "SalesRanking.h"
+
+void SalesRanking::init(int numberOfRecords)
+{
+    m_sales.assign(numberOfRecords, 0);
+    m_order.resize(numberOfRecords);
+    m_position.resize(numberOfRecords);
+    for (int i = 0; i < numberOfRecords; ++i) {
+        m_order[i] = i;
+        m_position[i] = i;
+    }
+    m_blockStart.assign(1, 0);
+}
+
+//new records have no sales so they go to the end of the order
+void SalesRanking::append(int numberOfRecords)
+{
+    for (int i = 0; i < numberOfRecords; ++i) {
+        int id = m_sales.size();
+        m_sales.push_back(0);
+        m_order.push_back(id);
+        m_position.push_back(id);
+    }
+}
+
+void SalesRanking::addSale(int id)
+{
+    int sales = m_sales[id];
+    if (sales + 1 == (int)m_blockStart.size())
+        m_blockStart.push_back(m_blockStart[sales]);
+
+    //swap the record to the front of its block and make it the last record of the next block
+    int first = m_blockStart[sales];
+    int other = m_order[first];
+    int position = m_position[id];
+    m_order[position] = other;
+    m_position[other] = position;
+    m_order[first] = id;
+    m_position[id] = first;
+
+    m_blockStart[sales]++;
+    m_sales[id]++;
+}
+
+int SalesRanking::getSales(int id) const
+{
+    return m_sales[id];
+}
+
+int SalesRanking::size() const
+{
+    return m_sales.size();
+}
+
+//k best selling records, ties in arbitrary order
+void SalesRanking::top(int k, std::vector<int>* out) const
+{
+    if (k > size())
+        k = size();
+    out->assign(m_order.begin(), m_order.begin() + k);
+}
+
+size_t SalesRanking::memoryUsage() const
+{
+    return (m_sales.capacity() + m_order.capacity() + m_position.capacity() + m_blockStart.capacity()) * sizeof(int);
+}
+
+void SalesRanking::save(SnapshotWriter& writer) const
+{
+    int size = m_sales.size();
+    int blocks = m_blockStart.size();
+    writer.write(size);
+    writer.write(blocks);
+    writer.writeArray(m_sales.data(), size);
+    writer.writeArray(m_order.data(), size);
+    writer.writeArray(m_position.data(), size);
+    writer.writeArray(m_blockStart.data(), blocks);
+}
+
+bool SalesRanking::load(SnapshotReader& reader)
+{
+    int size, blocks;
+    if (!reader.read(&size) || !reader.read(&blocks) || size < 0 || blocks < 1)
+        return false;
+
+    m_sales.resize(size);
+    m_order.resize(size);
+    m_position.resize(size);
+    m_blockStart.resize(blocks);
+    if (!reader.readArray(m_sales.data(), size) || !reader.readArray(m_order.data(), size) ||
+        !reader.readArray(m_position.data(), size) || !reader.readArray(m_blockStart.data(), blocks))
+        return false;
+    //the best sellers' block starts the order and every lower count starts at or after the one above it
+    if (m_blockStart[blocks - 1] != 0)
+        return false;
+    for (int c = 0; c < blocks; ++c) {
+        if (m_blockStart[c] < 0 || m_blockStart[c] > size || (c > 0 && m_blockStart[c] > m_blockStart[c - 1]))
+            return false;
+    }
+    for (int i = 0; i < size; ++i) {
+        if (m_order[i] < 0 || m_order[i] >= size || m_position[m_order[i]] != i ||
+            m_sales[i] < 0 || m_sales[i] >= blocks)
+            return false;
+    }
+    //so every record sits in the block of its sales
+    for (int i = 0; i < size; ++i) {
+        int sales = m_sales[i];
+        int end = sales == 0 ? size : m_blockStart[sales - 1];
+        if (m_position[i] < m_blockStart[sales] || m_position[i] >= end)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef WET2_SALESRANKING_H
+#define WET2_SALESRANKING_H
+
+#include <vector>
+#include "Snapshot.h"
+
+/*
+ * Records ordered by number of sales, best sellers first.
+ * Records with equal sales form a contiguous block, so a sale only swaps the record
+ * with the first record of its block and moves the block border: O(1) per sale.
+ */
+class SalesRanking {
+public:
+    //no records yet, like init(0)
+    SalesRanking() : m_blockStart(1, 0) {}
+    ~SalesRanking() = default;
+    SalesRanking(const SalesRanking& other) = delete;
+    SalesRanking& operator=(const SalesRanking& other) = delete;
+    void init(int numberOfRecords);
+    void append(int numberOfRecords);
+    void addSale(int id);
+    int getSales(int id) const;
+    int size() const;
+    void top(int k, std::vector<int>* out) const;
+    size_t memoryUsage() const;
+    void save(SnapshotWriter& writer) const;
+    bool load(SnapshotReader& reader);
+private:
+    std::vector<int> m_sales;
+    //record ids by descending sales, and each record's index in it
+    std::vector<int> m_order;
+    std::vector<int> m_position;
+    //m_blockStart[c] is the first index in m_order of the records with c sales
+    std::vector<int> m_blockStart;
+};
+
+
+#endif //WET2_SALESRANKING_H
@@ -0,0 +1,105 @@
+#include "Snapshot.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::vector<char>& SnapshotWriter::data()
+{
+    return m_data;
+}
+
+SnapshotReader::SnapshotReader(const char* data, size_t size) : m_data(data), m_size(size), m_position(0),
+                                                                m_failed(false)
+{}
+
+bool SnapshotReader::take(void* destination, size_t length)
+{
+    if (m_failed || length > m_size - m_position) {
+        m_failed = true;
+        return false;
+    }
+    if (length > 0)
+        memcpy(destination, m_data + m_position, length);
+    m_position += length;
+    return true;
+}
+
+bool SnapshotReader::failed() const
+{
+    return m_failed;
+}
+
+bool SnapshotReader::atEnd() const
+{
+    return m_position == m_size;
+}
+
+size_t SnapshotReader::remaining() const
+{
+    return m_failed ? 0 : m_size - m_position;
+}
+
+MappedFile::MappedFile(const std::string& path) : m_data(nullptr), m_size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            m_data = data;
+            m_size = status.st_size;
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+        munmap(m_data, m_size);
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const char* MappedFile::data() const
+{
+    return static_cast<const char*>(m_data);
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+bool writeFileAtomically(const std::string& path, const std::vector<char>& data)
+{
+    std::string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t result = ::write(fd, data.data() + written, data.size() - written);
+        if (result <= 0) {
+            close(fd);
+            unlink(temporary.c_str());
+            return false;
+        }
+        written += result;
+    }
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(temporary.c_str());
+        return false;
+    }
+    close(fd);
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,93 @@
+#ifndef WET2_SNAPSHOT_H
+#define WET2_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * Flat binary snapshot helpers. Values are stored in native byte order and layout,
+ * so a snapshot is only meant to be read back by the same build on the same machine.
+ */
+class SnapshotWriter {
+public:
+    template <class T>
+    void write(const T& value);
+    template <class T>
+    void writeArray(const T* values, int count);
+    std::vector<char>& data();
+private:
+    std::vector<char> m_data;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size);
+    //every read fails once a read ran past the end of the data
+    template <class T>
+    bool read(T* value);
+    template <class T>
+    bool readArray(T* values, int count);
+    bool failed() const;
+    bool atEnd() const;
+    //bytes not read yet, so a count can be checked before allocating for it
+    size_t remaining() const;
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_position;
+    bool m_failed;
+
+    bool take(void* destination, size_t length);
+};
+
+//read-only mapping of a whole file, empty if the file can't be mapped
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+    bool isOpen() const;
+    const char* data() const;
+    size_t size() const;
+private:
+    void* m_data;
+    size_t m_size;
+};
+
+//writes to a temporary file, syncs it and renames it over path so readers never see a partial snapshot
+bool writeFileAtomically(const std::string& path, const std::vector<char>& data);
+
+template<class T>
+void SnapshotWriter::write(const T& value)
+{
+    writeArray(&value, 1);
+}
+
+template<class T>
+void SnapshotWriter::writeArray(const T* values, int count)
+{
+    const char* bytes = reinterpret_cast<const char*>(values);
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(T) * count);
+}
+
+template<class T>
+bool SnapshotReader::read(T* value)
+{
+    return readArray(value, 1);
+}
+
+template<class T>
+bool SnapshotReader::readArray(T* values, int count)
+{
+    if (count < 0) {
+        m_failed = true;
+        return false;
+    }
+    return take(values, sizeof(T) * count);
+}
+
+
+#endif //WET2_SNAPSHOT_H
@@ -0,0 +1,93 @@
+#ifndef WET2_SPSCRING_H
+#define WET2_SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Bounded lock-free ring for exactly one producer thread and one consumer thread.
+ * Slots are reused in place: the producer fills claim() and publishes it,
+ * the consumer reads front() and releases it, so nothing is copied or allocated per item.
+ */
+template <class T>
+class SpscRing {
+public:
+    //capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity);
+    ~SpscRing();
+    SpscRing(const SpscRing& other) = delete;
+    SpscRing& operator=(const SpscRing& other) = delete;
+    //producer side, nullptr while the ring is full
+    T* claim();
+    void publish();
+    //consumer side, nullptr while the ring is empty
+    T* front();
+    void release();
+private:
+    static const size_t CACHE_LINE = 64;
+    T* m_slots;
+    size_t m_mask;
+    alignas(CACHE_LINE) std::atomic<size_t> m_head;
+    //consumer's copy of m_tail, refreshed only when the ring looks empty
+    size_t m_cachedTail;
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail;
+    //producer's copy of m_head, refreshed only when the ring looks full
+    size_t m_cachedHead;
+};
+
+template<class T>
+SpscRing<T>::SpscRing(size_t capacity) : m_slots(nullptr), m_mask(0), m_head(0), m_cachedTail(0), m_tail(0),
+                                         m_cachedHead(0)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    m_slots = new T[size];
+    m_mask = size - 1;
+}
+
+template<class T>
+SpscRing<T>::~SpscRing()
+{
+    delete[] m_slots;
+}
+
+template<class T>
+T* SpscRing<T>::claim()
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cachedHead > m_mask) {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        if (tail - m_cachedHead > m_mask)
+            return nullptr;
+    }
+    return &m_slots[tail & m_mask];
+}
+
+template<class T>
+void SpscRing<T>::publish()
+{
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<class T>
+T* SpscRing<T>::front()
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cachedTail) {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        if (head == m_cachedTail)
+            return nullptr;
+    }
+    return &m_slots[head & m_mask];
+}
+
+template<class T>
+void SpscRing<T>::release()
+{
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+
+#endif //WET2_SPSCRING_H
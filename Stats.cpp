@@ -0,0 +1,88 @@
+#include "Stats.h"
+
+static const char* CompanyOpStr[] =
+        {
+                "newMonth",
+                "addCostumer",
+                "getPhone",
+                "makeMember",
+                "isMember",
+                "buyRecord",
+                "addPrize",
+                "getExpenses",
+                "putOnTop",
+                "getPlace"
+        };
+
+const char* companyOpName(CompanyOp op)
+{
+    return CompanyOpStr[(int) op];
+}
+
+Histogram::Histogram() : m_counts(), m_count(0)
+{}
+
+void Histogram::add(long long value)
+{
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && value >= (1LL << bucket)) {
+        bucket++;
+    }
+    m_counts[bucket]++;
+    m_count++;
+}
+
+long long Histogram::count() const
+{
+    return m_count;
+}
+
+long long Histogram::percentile(double p) const
+{
+    long long rank = (long long) (p * m_count);
+    long long seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += m_counts[i];
+        if (seen > rank)
+            return 1LL << i;
+    }
+    return 0;
+}
+
+TableStats::TableStats() : m_size(0), m_capacity(0), m_loadFactor(0), m_resizes(0), m_maxBucketHeight(-1),
+                           m_avgBucketHeight(0), m_rotations(0)
+{}
+
+CacheStats::CacheStats() : m_entries(0), m_hits(0), m_misses(0)
+{}
+
+FindStats::FindStats() : m_finds(0), m_steps(0), m_maxPath(0)
+{}
+
+CompanyStats::CompanyStats() : m_enabled(false), m_members(0), m_memberTreeHeight(-1), m_memberRotations(0),
+                               m_records(0)
+{}
+
+MemoryUsage::MemoryUsage() : m_customerBuckets(0), m_customerNodes(0), m_customers(0), m_memberNodes(0),
+                             m_phoneIndex(0), m_sales(0), m_stacks(0), m_undoLog(0),
+                             m_customerCache(0), m_archives(0)
+{}
+
+size_t MemoryUsage::total() const
+{
+    return m_customerBuckets + m_customerNodes + m_customers + m_memberNodes + m_phoneIndex + m_sales + m_stacks +
+           m_undoLog + m_customerCache +
+           m_archives;
+}
+
+#ifdef RC_STATS
+ScopedLatency::ScopedLatency(Histogram* histogram) : m_histogram(histogram),
+                                                     m_start(std::chrono::steady_clock::now())
+{}
+
+ScopedLatency::~ScopedLatency()
+{
+    m_histogram->add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count());
+}
+#endif
@@ -0,0 +1,138 @@
+#ifndef WET2_STATS_H
+#define WET2_STATS_H
+
+/*
+ * Runtime counters of RecordsCompany internals.
+ * Counters and latency histograms are compiled in only with -DRC_STATS,
+ * sizes, load factor and tree heights are computed on demand either way.
+ */
+#ifdef RC_STATS
+#define RC_STATS_ONLY(statement) statement
+#else
+#define RC_STATS_ONLY(statement)
+#endif
+
+#include <cstddef>
+#ifdef RC_STATS
+#include <chrono>
+#endif
+
+typedef enum CompanyOp_t {
+    STAT_NEW_MONTH,
+    STAT_ADD_COSTUMER,
+    STAT_GET_PHONE,
+    STAT_MAKE_MEMBER,
+    STAT_IS_MEMBER,
+    STAT_BUY_RECORD,
+    STAT_ADD_PRIZE,
+    STAT_GET_EXPENSES,
+    STAT_PUT_ON_TOP,
+    STAT_GET_PLACE,
+    STAT_OP_COUNT
+} CompanyOp;
+
+const char* companyOpName(CompanyOp op);
+
+//power of two buckets: bucket i counts values in [2^(i-1), 2^i)
+class Histogram {
+public:
+    static const int BUCKETS = 40;
+    Histogram();
+    void add(long long value);
+    long long count() const;
+    //upper bound of the bucket holding the p-th value
+    long long percentile(double p) const;
+private:
+    long long m_counts[BUCKETS];
+    long long m_count;
+};
+
+class TableStats {
+public:
+    TableStats();
+    int m_size;
+    int m_capacity;
+    double m_loadFactor;
+    long long m_resizes;
+    //heights of the non-empty bucket trees, a single node has height 0
+    int m_maxBucketHeight;
+    double m_avgBucketHeight;
+    long long m_rotations;
+};
+
+class CacheStats {
+public:
+    CacheStats();
+    //0 when the cache is off
+    int m_entries;
+    long long m_hits;
+    long long m_misses;
+};
+
+class FindStats {
+public:
+    FindStats();
+    long long m_finds;
+    long long m_steps;
+    int m_maxPath;
+    Histogram m_paths;
+};
+
+/*
+ * Bytes held by each part of RecordsCompany, computed from sizes and capacities.
+ * They are the bytes asked from the allocator, its own per-allocation overhead isn't included.
+ */
+class MemoryUsage {
+public:
+    MemoryUsage();
+    size_t total() const;
+    //customer table: bucket array and bucket tree nodes
+    size_t m_customerBuckets;
+    size_t m_customerNodes;
+    //the Customer objects with their shared_ptr control blocks, or the compact pool
+    size_t m_customers;
+    size_t m_memberNodes;
+    //buckets and nodes of the phone index
+    size_t m_phoneIndex;
+    //SalesRanking arrays
+    size_t m_sales;
+    //UnionFind arrays, and its undo log with checkpoints
+    size_t m_stacks;
+    size_t m_undoLog;
+    size_t m_customerCache;
+    //encoded columns of the months archived in memory
+    size_t m_archives;
+};
+
+class CompanyStats {
+public:
+    CompanyStats();
+    //false when built without RC_STATS, counters and histograms are then empty
+    bool m_enabled;
+    TableStats m_customers;
+    CacheStats m_customerCache;
+    int m_members;
+    int m_memberTreeHeight;
+    long long m_memberRotations;
+    int m_records;
+    FindStats m_finds;
+    MemoryUsage m_memory;
+    Histogram m_latency[STAT_OP_COUNT];
+};
+
+#ifdef RC_STATS
+//adds the lifetime of the object to a latency histogram in nanoseconds
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Histogram* histogram);
+    ~ScopedLatency();
+    ScopedLatency(const ScopedLatency& other) = delete;
+    ScopedLatency& operator=(const ScopedLatency& other) = delete;
+private:
+    Histogram* m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+#endif
+
+
+#endif //WET2_STATS_H
@@ -0,0 +1,174 @@
+#include "StoreHost.h"
+#include <system_error>
+
+StoreHost::StoreHost(int workers) : m_remaining(0), m_stopping(false), m_commands(nullptr), m_results(nullptr)
+{
+    if (workers < 1)
+        workers = 1;
+    //the workers already started must be joined before the exception leaves, or their threads terminate the process
+    try {
+        m_workers.reserve(workers);
+        for (int i = 0; i < workers; ++i) {
+            m_workers.emplace_back(&StoreHost::work, this);
+        }
+    } catch (std::system_error& e) {
+        stopWorkers();
+        throw;
+    } catch (std::bad_alloc& e) {
+        stopWorkers();
+        throw;
+    }
+}
+
+StoreHost::~StoreHost()
+{
+    stopWorkers();
+    m_stores.forEach([](const int&, HostedStore* store) { delete store; });
+}
+
+void StoreHost::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void StoreHost::clearPending()
+{
+    for (HostedStore* store : m_ready) {
+        store->m_pending.clear();
+    }
+}
+
+StatusType StoreHost::addStore(int storeId)
+{
+    if (storeId < 0)
+        return INVALID_INPUT;
+
+    std::lock_guard<std::mutex> batch(m_batchMutex);
+    if (m_stores.find(storeId) != nullptr)
+        return ALREADY_EXISTS;
+    HostedStore* store = nullptr;
+    try {
+        store = new HostedStore(storeId);
+        m_stores.tryEmplace(storeId, store);
+    } catch (std::bad_alloc& e) {
+        delete store;
+        return ALLOCATION_ERROR;
+    }
+    return SUCCESS;
+}
+
+StatusType StoreHost::removeStore(int storeId)
+{
+    if (storeId < 0)
+        return INVALID_INPUT;
+
+    std::lock_guard<std::mutex> batch(m_batchMutex);
+    HostedStore** store = m_stores.find(storeId);
+    if (store == nullptr)
+        return DOESNT_EXISTS;
+    delete *store;
+    m_stores.remove(storeId);
+    return SUCCESS;
+}
+
+RecordsCompany* StoreHost::getStore(int storeId)
+{
+    HostedStore** store = m_stores.find(storeId);
+    return store == nullptr ? nullptr : &(*store)->m_company;
+}
+
+int StoreHost::storeCount() const
+{
+    return m_stores.getSize();
+}
+
+int StoreHost::workerCount() const
+{
+    return (int) m_workers.size();
+}
+
+size_t StoreHost::memoryUsage()
+{
+    std::lock_guard<std::mutex> batch(m_batchMutex);
+    size_t bytes = m_stores.bucketBytes() + m_stores.nodeBytes();
+    m_stores.forEach([&bytes](const int&, HostedStore* store) {
+        bytes += sizeof(HostedStore) + store->m_company.memoryUsage().total();
+    });
+    return bytes;
+}
+
+StatusType StoreHost::executeBatch(const int* storeIds, Command* commands, int count, CommandResult* results)
+{
+    if (count < 0 || (count > 0 && (storeIds == nullptr || commands == nullptr || results == nullptr)))
+        return INVALID_INPUT;
+
+    std::lock_guard<std::mutex> batch(m_batchMutex);
+    try {
+        m_ready.clear();
+        for (int i = 0; i < count; ++i) {
+            HostedStore** store = storeIds[i] < 0 ? nullptr : m_stores.find(storeIds[i]);
+            if (store == nullptr) {
+                results[i].m_op = commands[i].m_op;
+                results[i].m_kind = RESULT_STATUS;
+                results[i].m_status = DOESNT_EXISTS;
+                continue;
+            }
+            if ((*store)->m_pending.empty())
+                m_ready.push_back(*store);
+            (*store)->m_pending.push_back(i);
+        }
+    } catch (std::bad_alloc& e) {
+        clearPending();
+        return ALLOCATION_ERROR;
+    }
+    if (m_ready.empty())
+        return SUCCESS;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    try {
+        m_queue.insert(m_queue.end(), m_ready.begin(), m_ready.end());
+    } catch (std::bad_alloc& e) {
+        //the queue is empty between batches, and no worker saw the part that made it in
+        m_queue.clear();
+        clearPending();
+        return ALLOCATION_ERROR;
+    }
+    m_commands = commands;
+    m_results = results;
+    m_remaining = (int) m_ready.size();
+    m_work.notify_all();
+    m_done.wait(lock, [this] { return m_remaining == 0; });
+    return SUCCESS;
+}
+
+void StoreHost::run(HostedStore* store)
+{
+    for (int i : store->m_pending) {
+        executeCommand(&store->m_company, m_commands[i], &m_results[i]);
+    }
+    store->m_pending.clear();
+}
+
+void StoreHost::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_work.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty())
+            return;
+        HostedStore* store = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        run(store);
+        lock.lock();
+        if (--m_remaining == 0)
+            m_done.notify_one();
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef WET2_STOREHOST_H
+#define WET2_STOREHOST_H
+
+#include "CommandExecutor.h"
+#include "HashTable.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//one tenant of a StoreHost
+class HostedStore {
+public:
+    explicit HostedStore(int storeId) : m_storeId(storeId) {}
+    HostedStore(const HostedStore& other) = delete;
+    HostedStore& operator=(const HostedStore& other) = delete;
+    int m_storeId;
+    RecordsCompany m_company;
+    //positions of this store's commands in the running batch, in order
+    std::vector<int> m_pending;
+};
+
+/*
+ * Many independent RecordsCompany instances in one process, addressed by store id.
+ * A batch of commands is split by store: each store's commands run in order on one worker,
+ * different stores run in parallel on a fixed pool of workers.
+ * Stores are added, removed and configured (logs, snapshots, archives) between batches only.
+ */
+class StoreHost {
+public:
+    //at least one worker, throws what starting a worker threw after stopping the ones already started
+    explicit StoreHost(int workers);
+    ~StoreHost();
+    StoreHost(const StoreHost& other) = delete;
+    StoreHost& operator=(const StoreHost& other) = delete;
+    StatusType addStore(int storeId);
+    StatusType removeStore(int storeId);
+    //nullptr if there's no such store, not to be used while a batch runs
+    RecordsCompany* getStore(int storeId);
+    int storeCount() const;
+    int workerCount() const;
+    /*
+     * Runs commands[i] on store storeIds[i] into results[i] and returns once all of them ran.
+     * A command for a missing store gets DOESNT_EXISTS. One batch runs at a time.
+     */
+    StatusType executeBatch(const int* storeIds, Command* commands, int count, CommandResult* results);
+    //memoryUsage of every store plus the stores themselves
+    size_t memoryUsage();
+private:
+    HashTable<int, HostedStore*> m_stores;
+    std::vector<std::thread> m_workers;
+    //held for a whole batch, and while stores are added or removed
+    std::mutex m_batchMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_done;
+    std::deque<HostedStore*> m_queue;
+    //stores of the running batch not finished yet
+    int m_remaining;
+    bool m_stopping;
+    Command* m_commands;
+    CommandResult* m_results;
+    std::vector<HostedStore*> m_ready;
+
+    void work();
+    void run(HostedStore* store);
+    void stopWorkers();
+    //forgets the commands of a batch that couldn't start
+    void clearPending();
+};
+
+
+#endif //WET2_STOREHOST_H
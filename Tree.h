@@ -6,14 +6,21 @@
 #define WET1_TREE_H
 
 #include "Node.h"
+#include "Stats.h"
 #include <memory>
 #include <functional>
+#include <new>
+#include <queue>
+#include <utility>
+#include <vector>
 
 template <typename Key, typename Value> class HashTable;
 
-using std::unique_ptr;
-
-template <class Key, class Value>
+/*
+ * AVL tree. Augment is PlainAugment or PrizeAugment (see Node.h), the prize methods
+ * only compile for a prize tree.
+ */
+template <class Key, class Value, class Augment = PlainAugment>
 class Tree {
 public:
     /*
@@ -26,102 +33,437 @@ public:
     /*
      * Methods
      */
+    //true if key was already in the tree
     bool insert(const Key& key, const Value& value);
+    /*
+     * Builds the value from args in the new node if key isn't in the tree, args are left alone otherwise.
+     * Returns the stored value and whether it was inserted.
+     */
+    template <class... Args>
+    std::pair<Value*, bool> tryEmplace(const Key& key, Args&&... args);
+    //builds the value first, then moves it in if key isn't in the tree
+    template <class... Args>
+    std::pair<Value*, bool> emplace(const Key& key, Args&&... args);
     bool remove(const Key& key);
-    Node<Key, Value>* getRoot() const;
-    void deleteTree(Node<Key, Value>* current);
-    Node<Key, Value>* find(const Key& key, Node<Key, Value>* current) const;
-    Node<Key, Value>* findMin(Node<Key, Value>* current) const;
+    Node<Key, Value, Augment>* getRoot() const;
+    void deleteTree(Node<Key, Value, Augment>* current);
+    Node<Key, Value, Augment>* find(const Key& key, Node<Key, Value, Augment>* current) const;
+    Node<Key, Value, Augment>* findMin(Node<Key, Value, Augment>* current) const;
+    //the node with the smallest key not below key, nullptr if there is none
+    Node<Key, Value, Augment>* lowerBound(const Key& key) const;
+    int getHeight() const;
+    int getSize() const;
+    //bytes of the nodes, the values' own allocations and allocator overhead aren't counted
+    size_t nodeBytes() const;
+    void clear();
+    //calls function(key, value) in key order
+    template <class Function>
+    void forEachInOrder(Function function) const;
+    //forEachInOrder of the keys in [low, high] only
+    template <class Function>
+    void forEachInRange(const Key& low, const Key& high, Function function) const;
+    //forEachInOrder calling function(key, value, prize), the prize being the sum of the extras on the path, prize tree only
+    template <class Function>
+    void forEachWithPrize(Function function) const;
+    /*
+     * Calls function(key, value, extra) in pre-order with each node's own stored extra. The extras
+     * only add up to the prizes along the paths of this shape, so restoring them needs the same shape.
+     */
+    template <class Function>
+    void forEachPreOrder(Function function) const;
+    //replaces the tree with the one forEachPreOrder walked in O(n), false if the keys aren't a valid pre-order
+    bool buildFromPreOrder(const Key* keys, const Value* values, const Money* extras, int count);
+    //rotations done so far, always 0 without RC_STATS
+    long long getRotations() const;
+    /*
+     * Moves every node into newTable[hash(key)] and leaves this tree empty. The nodes themselves are
+     * relinked, so nothing is allocated and nothing can throw. The keys must not be in newTable yet.
+     */
+    template <class Hash>
+    void moveNodes(Tree<Key, Value, Augment>* newTable, Hash hash);
+    /*
+     * RecordCompany adapted methods, prize tree only
+     */
+    void addPrizeAux(Node<Key, Value, Augment> *current, const int &id1, const int &id2, const Money &amount);
+    void addPrize(const int &id1, const int &id2, const Money &amount);
+    void updateExtraLeft(Node<Key, Value, Augment> *current, const int &id, const Money &amount, int prevTurn);
+    void updateExtraRight(Node<Key, Value, Augment> *current, const int &id, const Money &amount, int prevTurn);
+    //the node of id with the sum of the extras on its path, nullptr if id isn't in the tree
+    Node<Key, Value, Augment>* sumUpExtra(const Key& id, Money* sum);
+    //zeroes every extra, for a new month, after the values' expenses changed
+    void resetExtras();
+    //refreshes the subtree maxima above key's node after its value's expenses changed
+    void updatePath(const Key& key);
     /*
-     * RecordCompany adapted methods
+     * Keys of the k nodes with the largest expenses minus prize, largest first, equal ones in no
+     * particular order. Best-first search on the subtree maxima: O(k log n).
      */
-    void addPrizeAux(Node<Key, Value> *current, const int &id1, const int &id2, const double &amount);
-    void addPrize(const int &id1, const int &id2, const double &amount);
-    void updateExtraLeft(Node<Key, Value> *current, const int &id, const double &amount, int prevTurn);
-    void updateExtraRight(Node<Key, Value> *current, const int &id, const double &amount, int prevTurn);
-    void inOrder(Node<Key, Value>* current, Tree<Key, Value>* newTable,
-                 std::function<size_t(const Key&)> hash_function);
-    void inOrderNullify(Node<Key, Value>* current);
-    bool sumUpExtra(const Key& id, double* sum);
-    void resetExpenses(Node<Key, Value>* current);
+    void topByExpenses(int k, std::vector<Key>* out) const;
 
 private:
-    Node<Key, Value>* m_root;
-    unique_ptr<Node<Key, Value>> m_minNode;
+    Node<Key, Value, Augment>* m_root;
     int m_size;
+#ifdef RC_STATS
+    long long m_rotations;
+#endif
     /*
      * Private Methods
      */
-    Node<Key, Value>* rotateLeft(Node<Key, Value>* current);
-    Node<Key, Value>* rotateRight(Node<Key, Value>* current);
-    void updateExtraOnLeftRotation(Node<Key, Value>* current);
-    void updateExtraOnRightRotation(Node<Key, Value>* current);
-    Node<Key, Value>* balance(Node<Key, Value>* current);
-    Node<Key, Value>* insert(Node<Key, Value>* nodeToInsert, Node<Key, Value>* current, bool* doesExist);
-    Node<Key, Value>* remove(const Key& key, Node<Key, Value>* current, bool* doesExist);
+    Node<Key, Value, Augment>* rotateLeft(Node<Key, Value, Augment>* current);
+    Node<Key, Value, Augment>* rotateRight(Node<Key, Value, Augment>* current);
+    Node<Key, Value, Augment>* balance(Node<Key, Value, Augment>* current);
+    template <class... Args>
+    Node<Key, Value, Augment>* insert(Node<Key, Value, Augment>* current, const Key& key,
+                                      Node<Key, Value, Augment>** node, bool* inserted, Args&&... args);
+    Node<Key, Value, Augment>* remove(const Key& key, Node<Key, Value, Augment>* current, bool* doesExist);
+    template <class Hash>
+    void moveNodes(Node<Key, Value, Augment>* current, Tree<Key, Value, Augment>* newTable, Hash& hash);
+    //links a detached node with a new key in below current
+    Node<Key, Value, Augment>* attach(Node<Key, Value, Augment>* current, Node<Key, Value, Augment>* node);
+    template <class Function>
+    void forEachInOrder(Node<Key, Value, Augment>* current, Function& function) const;
+    template <class Function>
+    void forEachInRange(Node<Key, Value, Augment>* current, const Key& low, const Key& high, Function& function) const;
+    template <class Function>
+    void forEachWithPrize(Node<Key, Value, Augment>* current, Money prize, Function& function) const;
+    template <class Function>
+    void forEachPreOrder(Node<Key, Value, Augment>* current, Function& function) const;
+    Node<Key, Value, Augment>* buildFromPreOrder(const Key* keys, const Value* values, const Money* extras, int count,
+                                        int* next, const Key* low, const Key* high);
+    void postOrderNullify(Node<Key, Value, Augment>* current);
+    bool updatePath(const Key& key, Node<Key, Value, Augment>* current);
+    void updatePaths(const Key& low, const Key& high, Node<Key, Value, Augment>* current);
     static int max(int a, int b);
 };
 
-template<class Key, class Value>
-void Tree<Key, Value>::inOrderNullify(Node<Key, Value> *current)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::resetExtras()
+{
+    postOrderNullify(m_root);
+}
+
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::postOrderNullify(Node<Key, Value, Augment> *current)
 {
     if (current == nullptr)
         return;
 
-    inOrderNullify(current->getLeft());
+    postOrderNullify(current->getLeft());
+    postOrderNullify(current->getRight());
     current->newMonthNullify();
-    inOrderNullify(current->getRight());
+    Augment::update(current);
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::resetExpenses(Node<Key, Value> *current)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::updatePath(const Key& key)
+{
+    updatePath(key, m_root);
+}
+
+//updates the nodes on the search path of key bottom up, true if key was found
+template <class Key, class Value, class Augment>
+bool Tree<Key, Value, Augment>::updatePath(const Key& key, Node<Key, Value, Augment>* current)
+{
+    if (current == nullptr)
+        return false;
+
+    bool found = true;
+    if (key < current->getKey())
+        found = updatePath(key, current->getLeft());
+    else if (current->getKey() < key)
+        found = updatePath(key, current->getRight());
+    Augment::update(current);
+    return found;
+}
+
+//updatePath of low and of high, walking their common part once
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::updatePaths(const Key& low, const Key& high, Node<Key, Value, Augment>* current)
 {
     if (current == nullptr)
         return;
 
-    resetExpenses(current->getLeft());
-    current->getValue()->resetExpenses();
-    current->newMonthNullify();
-    resetExpenses(current->getRight());
+    if (high < current->getKey()) {
+        updatePaths(low, high, current->getLeft());
+    } else if (current->getKey() < low) {
+        updatePaths(low, high, current->getRight());
+    } else {
+        if (low < current->getKey())
+            updatePath(low, current->getLeft());
+        if (current->getKey() < high)
+            updatePath(high, current->getRight());
+    }
+    Augment::update(current);
 }
 
-template<class Key, class Value>
-bool Tree<Key, Value>::sumUpExtra(const Key &id, double* sum)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::topByExpenses(int k, std::vector<Key>* out) const
 {
-    Node<Key, Value>* current = this->getRoot();
+    //a whole subtree is ranked by its maximum, a single node by its own expenses minus prize
+    struct Candidate {
+        Money m_expenses;
+        //sum of the extras above the node
+        Money m_above;
+        Node<Key, Value, Augment>* m_node;
+        bool m_whole;
+        bool operator<(const Candidate& other) const
+        {
+            return m_expenses < other.m_expenses;
+        }
+    };
+    out->clear();
+    if (m_root == nullptr || k <= 0)
+        return;
+
+    std::priority_queue<Candidate> candidates;
+    candidates.push(Candidate{m_root->getSubtreeMax(), 0, m_root, true});
+    while (!candidates.empty() && (int) out->size() < k) {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        Node<Key, Value, Augment>* node = candidate.m_node;
+        if (!candidate.m_whole) {
+            out->push_back(node->getKey());
+            continue;
+        }
+        Money above = candidate.m_above + node->getExtra();
+        candidates.push(Candidate{node->getValue()->getExpenses() - above, above, node, false});
+        if (node->getLeft() != nullptr)
+            candidates.push(Candidate{node->getLeft()->getSubtreeMax() - above, above, node->getLeft(), true});
+        if (node->getRight() != nullptr)
+            candidates.push(Candidate{node->getRight()->getSubtreeMax() - above, above, node->getRight(), true});
+    }
+}
+
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::sumUpExtra(const Key &id, Money* sum)
+{
+    Node<Key, Value, Augment>* current = this->getRoot();
     while (current != nullptr)
     {
         *sum += current->getExtra();
-        if (current->getKey() == id) {
-            *sum = current->getValue()->getExpenses() - *sum;
-            return true;
-        }
+        if (current->getKey() == id)
+            return current;
         else if (current->getKey() > id)
             current = current->getLeft();
         else
             current = current->getRight();
     }
-    return false;
+    return nullptr;
+}
+
+template <class Key, class Value, class Augment>
+template <class Hash>
+void Tree<Key, Value, Augment>::moveNodes(Tree<Key, Value, Augment>* newTable, Hash hash)
+{
+    moveNodes(m_root, newTable, hash);
+    m_root = nullptr;
+    m_size = 0;
+}
+
+//post-order, so a node's children are read before it's detached
+template <class Key, class Value, class Augment>
+template <class Hash>
+void Tree<Key, Value, Augment>::moveNodes(Node<Key, Value, Augment>* current, Tree<Key, Value, Augment>* newTable,
+                                          Hash& hash)
+{
+    if (current == nullptr)
+        return;
+
+    moveNodes(current->getLeft(), newTable, hash);
+    moveNodes(current->getRight(), newTable, hash);
+    current->setLeft(nullptr);
+    current->setRight(nullptr);
+    current->setHeight(0);
+    Tree<Key, Value, Augment>& bucket = newTable[hash(current->getKey())];
+    bucket.m_root = bucket.attach(bucket.m_root, current);
+    bucket.m_size++;
+}
+
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::attach(Node<Key, Value, Augment>* current,
+                                                             Node<Key, Value, Augment>* node)
+{
+    if (current == nullptr) {
+        Augment::attached(this->getRoot(), node);
+        Augment::update(node);
+        return node;
+    }
+
+    if (node->getKey() < current->getKey())
+        current->setLeft(attach(current->getLeft(), node));
+    else
+        current->setRight(attach(current->getRight(), node));
+    return balance(current);
+}
+
+template <class Key, class Value, class Augment>
+Tree<Key, Value, Augment>::Tree() : m_root(nullptr), m_size(0)
+{
+    RC_STATS_ONLY(m_rotations = 0;)
+}
+
+template <class Key, class Value, class Augment>
+int Tree<Key, Value, Augment>::getHeight() const
+{
+    return m_root == nullptr ? -1 : m_root->getHeight();
+}
+
+template <class Key, class Value, class Augment>
+int Tree<Key, Value, Augment>::getSize() const
+{
+    return m_size;
+}
+
+template <class Key, class Value, class Augment>
+size_t Tree<Key, Value, Augment>::nodeBytes() const
+{
+    return m_size * sizeof(Node<Key, Value, Augment>);
+}
+
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::clear()
+{
+    deleteTree(m_root);
+    m_root = nullptr;
+    m_size = 0;
+}
+
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachInOrder(Function function) const
+{
+    forEachInOrder(m_root, function);
+}
+
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachInOrder(Node<Key, Value, Augment>* current, Function& function) const
+{
+    if (current == nullptr)
+        return;
+
+    forEachInOrder(current->getLeft(), function);
+    function(current->getKey(), current->getValue());
+    forEachInOrder(current->getRight(), function);
+}
+
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachInRange(const Key& low, const Key& high, Function function) const
+{
+    forEachInRange(m_root, low, high, function);
+}
+
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachInRange(Node<Key, Value, Augment>* current, const Key& low, const Key& high,
+                                               Function& function) const
+{
+    if (current == nullptr)
+        return;
+
+    if (low < current->getKey())
+        forEachInRange(current->getLeft(), low, high, function);
+    if (!(current->getKey() < low) && !(high < current->getKey()))
+        function(current->getKey(), current->getValue());
+    if (current->getKey() < high)
+        forEachInRange(current->getRight(), low, high, function);
+}
+
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachWithPrize(Function function) const
+{
+    forEachWithPrize(m_root, 0, function);
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::inOrder(Node<Key, Value> *current, Tree<Key, Value>* newTable,
-                               std::function<size_t(const Key&)> hash_function)
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachWithPrize(Node<Key, Value, Augment>* current, Money prize,
+                                                 Function& function) const
 {
     if (current == nullptr)
         return;
 
-    inOrder(current->getLeft(), newTable, hash_function);
-    size_t index = hash_function(current->getKey());
-    newTable[index].insert(current->getKey(), current->getValue());
-    inOrder(current->getRight(), newTable, hash_function);
+    prize += current->getExtra();
+    forEachWithPrize(current->getLeft(), prize, function);
+    function(current->getKey(), current->getValue(), prize);
+    forEachWithPrize(current->getRight(), prize, function);
 }
 
-template <class Key, class Value>
-Tree<Key, Value>::Tree() : m_root(nullptr), m_minNode(nullptr), m_size(0) {}
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachPreOrder(Function function) const
+{
+    forEachPreOrder(m_root, function);
+}
+
+template <class Key, class Value, class Augment>
+template<class Function>
+void Tree<Key, Value, Augment>::forEachPreOrder(Node<Key, Value, Augment>* current, Function& function) const
+{
+    if (current == nullptr)
+        return;
+
+    function(current->getKey(), current->getValue(), current->getExtra());
+    forEachPreOrder(current->getLeft(), function);
+    forEachPreOrder(current->getRight(), function);
+}
+
+template <class Key, class Value, class Augment>
+bool Tree<Key, Value, Augment>::buildFromPreOrder(const Key* keys, const Value* values, const Money* extras, int count)
+{
+    clear();
+    int next = 0;
+    m_root = buildFromPreOrder(keys, values, extras, count, &next, nullptr, nullptr);
+    if (next != count) {
+        clear();
+        return false;
+    }
+    m_size = count;
+    return true;
+}
+
+//builds the subtree of the keys strictly between low and high, a null bound is open
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::buildFromPreOrder(const Key* keys, const Value* values, const Money* extras,
+                                                      int count, int* next, const Key* low, const Key* high)
+{
+    if (*next == count)
+        return nullptr;
+    const Key& key = keys[*next];
+    if ((low != nullptr && !(*low < key)) || (high != nullptr && !(key < *high)))
+        return nullptr;
+
+    auto* node = new Node<Key, Value, Augment>(key, values[*next]);
+    node->setExtra(extras[*next]);
+    (*next)++;
+    try {
+        node->setLeft(buildFromPreOrder(keys, values, extras, count, next, low, &node->getKey()));
+        node->setRight(buildFromPreOrder(keys, values, extras, count, next, &node->getKey(), high));
+    } catch (std::bad_alloc& e) {
+        deleteTree(node);
+        throw;
+    }
+    int leftHeight = node->getLeft() == nullptr ? -1 : node->getLeft()->getHeight();
+    int rightHeight = node->getRight() == nullptr ? -1 : node->getRight()->getHeight();
+    node->setHeight(max(leftHeight, rightHeight) + 1);
+    Augment::update(node);
+    return node;
+}
+
+template <class Key, class Value, class Augment>
+long long Tree<Key, Value, Augment>::getRotations() const
+{
+#ifdef RC_STATS
+    return m_rotations;
+#else
+    return 0;
+#endif
+}
 
-template<class Key, class Value>
-void Tree<Key, Value>::deleteTree(Node<Key, Value>* current)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::deleteTree(Node<Key, Value, Augment>* current)
 {
     if (current == nullptr)
         return;
@@ -131,20 +473,20 @@ void Tree<Key, Value>::deleteTree(Node<Key, Value>* current)
     delete current;
 }
 
-template <class Key, class Value>
-Tree<Key, Value>::~Tree()
+template <class Key, class Value, class Augment>
+Tree<Key, Value, Augment>::~Tree()
 {
     deleteTree(this->m_root);
 }
 
-template<class Key, class Value>
-int Tree<Key, Value>::max(int a, int b)
+template <class Key, class Value, class Augment>
+int Tree<Key, Value, Augment>::max(int a, int b)
 {
     return (a > b) ? a : b;
 }
 
-template<class Key, class Value>
-Node<Key, Value> *Tree<Key, Value>::findMin(Node<Key, Value> *current) const
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment> *Tree<Key, Value, Augment>::findMin(Node<Key, Value, Augment> *current) const
 {
     if (current == nullptr)
     {
@@ -157,8 +499,24 @@ Node<Key, Value> *Tree<Key, Value>::findMin(Node<Key, Value> *current) const
     return findMin(current->getLeft());
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::updateExtraLeft(Node<Key, Value> *current, const int &id, const double &amount, int prevTurn)
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::lowerBound(const Key& key) const
+{
+    Node<Key, Value, Augment>* best = nullptr;
+    Node<Key, Value, Augment>* current = m_root;
+    while (current != nullptr) {
+        if (current->getKey() < key) {
+            current = current->getRight();
+        } else {
+            best = current;
+            current = current->getLeft();
+        }
+    }
+    return best;
+}
+
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::updateExtraLeft(Node<Key, Value, Augment> *current, const int &id, const Money &amount, int prevTurn)
 {
     if (current == nullptr)
         return;
@@ -203,8 +561,8 @@ void Tree<Key, Value>::updateExtraLeft(Node<Key, Value> *current, const int &id,
     }
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::updateExtraRight(Node<Key, Value> *current, const int &id, const double &amount, int prevTurn)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::updateExtraRight(Node<Key, Value, Augment> *current, const int &id, const Money &amount, int prevTurn)
 {
     if (current == nullptr)
         return;
@@ -249,8 +607,8 @@ void Tree<Key, Value>::updateExtraRight(Node<Key, Value> *current, const int &id
     }
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::addPrizeAux(Node<Key, Value> *current, const int &id1, const int &id2, const double &amount)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::addPrizeAux(Node<Key, Value, Augment> *current, const int &id1, const int &id2, const Money &amount)
 {
     if (current == nullptr)
         return;
@@ -283,15 +641,17 @@ void Tree<Key, Value>::addPrizeAux(Node<Key, Value> *current, const int &id1, co
     }
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::addPrize(const int &id1, const int &id2, const double &amount)
+template <class Key, class Value, class Augment>
+void Tree<Key, Value, Augment>::addPrize(const int &id1, const int &id2, const Money &amount)
 {
     addPrizeAux(this->m_root, id1, id2, amount);
+    //every extra changed is on the search path of id1 or id2 or a child of it
+    updatePaths(id1, id2, this->m_root);
 }
 
 
-template<class Key, class Value>
-Node<Key, Value>* Tree<Key, Value>::find(const Key &key, Node<Key, Value>* current) const
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::find(const Key &key, Node<Key, Value, Augment>* current) const
 {
     if (current == nullptr) {
         return nullptr;
@@ -305,29 +665,20 @@ Node<Key, Value>* Tree<Key, Value>::find(const Key &key, Node<Key, Value>* curre
     return find(key, current->getRight());
 }
 
-template<class Key, class Value>
-Node<Key, Value> *Tree<Key, Value>::getRoot() const
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment> *Tree<Key, Value, Augment>::getRoot() const
 {
     return this->m_root;
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::updateExtraOnLeftRotation(Node<Key, Value> *current)
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::rotateLeft(Node<Key, Value, Augment>* current)
 {
-    double temp = current->getRight()->getExtra();
-    current->getRight()->setExtra(current->getExtra());
-    current->setExtra(-(current->getRight()->getExtra()));
-    if (current->getRight()->getLeft() != nullptr)
-        current->getRight()->getLeft()->setExtra(temp);
-}
-
-template<class Key, class Value>
-Node<Key, Value>* Tree<Key, Value>::rotateLeft(Node<Key, Value>* current)
-{
-    Node<Key, Value>* rightSubTree = current->getRight();
-    Node<Key, Value>* rightLeftSubTree = rightSubTree->getLeft();
+    Node<Key, Value, Augment>* rightSubTree = current->getRight();
+    Node<Key, Value, Augment>* rightLeftSubTree = rightSubTree->getLeft();
 
-    updateExtraOnLeftRotation(current);
+    Augment::beforeLeftRotation(current);
+    RC_STATS_ONLY(m_rotations++;)
 
     rightSubTree->setLeft(current);
     current->setRight(rightLeftSubTree);
@@ -335,31 +686,24 @@ Node<Key, Value>* Tree<Key, Value>::rotateLeft(Node<Key, Value>* current)
     int leftHeight = current->getLeft() == nullptr ? -1 : current->getLeft()->getHeight();
     int rightHeight = current->getRight() == nullptr ? -1 : current->getRight()->getHeight();
     current->setHeight(max(leftHeight, rightHeight) + 1);
+    Augment::update(current);
 
     leftHeight = rightSubTree->getLeft() == nullptr ? -1 : rightSubTree->getLeft()->getHeight();
     rightHeight = rightSubTree->getRight() == nullptr ? -1 : rightSubTree->getRight()->getHeight();
     rightSubTree->setHeight(max(leftHeight, rightHeight) + 1);
+    Augment::update(rightSubTree);
 
     return rightSubTree;
 }
 
-template<class Key, class Value>
-void Tree<Key, Value>::updateExtraOnRightRotation(Node<Key, Value> *current)
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment> *Tree<Key, Value, Augment>::rotateRight(Node<Key, Value, Augment> *current)
 {
-    double temp = current->getLeft()->getExtra();
-    current->getLeft()->setExtra(current->getExtra());
-    current->setExtra(-(current->getLeft()->getExtra()));
-    if (current->getLeft()->getRight() != nullptr)
-        current->getLeft()->getRight()->setExtra(temp);
-}
+    Node<Key, Value, Augment>* leftSubTree = current->getLeft();
+    Node<Key, Value, Augment>* leftRightSubTree = leftSubTree->getRight();
 
-template<class Key, class Value>
-Node<Key, Value> *Tree<Key, Value>::rotateRight(Node<Key, Value> *current)
-{
-    Node<Key, Value>* leftSubTree = current->getLeft();
-    Node<Key, Value>* leftRightSubTree = leftSubTree->getRight();
-
-    updateExtraOnRightRotation(current);
+    Augment::beforeRightRotation(current);
+    RC_STATS_ONLY(m_rotations++;)
 
     leftSubTree->setRight(current);
     current->setLeft(leftRightSubTree);
@@ -367,16 +711,18 @@ Node<Key, Value> *Tree<Key, Value>::rotateRight(Node<Key, Value> *current)
     int leftHeight = current->getLeft() == nullptr ? -1 : current->getLeft()->getHeight();
     int rightHeight = current->getRight() == nullptr ? -1 : current->getRight()->getHeight();
     current->setHeight(max(leftHeight, rightHeight) + 1);
+    Augment::update(current);
 
     leftHeight = leftSubTree->getLeft() == nullptr ? -1 : leftSubTree->getLeft()->getHeight();
     rightHeight = leftSubTree->getRight() == nullptr ? -1 : leftSubTree->getRight()->getHeight();
     leftSubTree->setHeight(max(leftHeight, rightHeight) + 1);
+    Augment::update(leftSubTree);
 
     return leftSubTree;
 }
 
-template<class Key, class Value>
-Node<Key, Value> *Tree<Key, Value>::balance(Node<Key, Value> *current)
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment> *Tree<Key, Value, Augment>::balance(Node<Key, Value, Augment> *current)
 {
     if (current == nullptr) {
         return current;
@@ -384,6 +730,7 @@ Node<Key, Value> *Tree<Key, Value>::balance(Node<Key, Value> *current)
     int leftHeight = current->getLeft() == nullptr ? -1 : current->getLeft()->getHeight();
     int rightHeight = current->getRight() == nullptr ? -1 : current->getRight()->getHeight();
     current->setHeight(max(leftHeight, rightHeight) + 1);
+    Augment::update(current);
     int balanceFactor = current->getBalanceFactor();
 
     // Left heavy
@@ -392,7 +739,7 @@ Node<Key, Value> *Tree<Key, Value>::balance(Node<Key, Value> *current)
         if (current->getLeft()->getBalanceFactor() < 0) {
             current->setLeft(rotateLeft(current->getLeft()));
         }
-        Node<Key, Value>* newRoot = rotateRight(current);
+        Node<Key, Value, Augment>* newRoot = rotateRight(current);
         return newRoot;
     }
     // Right heavy
@@ -408,67 +755,64 @@ Node<Key, Value> *Tree<Key, Value>::balance(Node<Key, Value> *current)
     return current;
 }
 
-template<class Key, class Value>
-Node<Key, Value>* Tree<Key, Value>::insert(Node<Key, Value>* nodeToInsert ,Node<Key, Value>* current, bool* doesExist)
+template <class Key, class Value, class Augment>
+template <class... Args>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::insert(Node<Key, Value, Augment>* current, const Key& key,
+                                                             Node<Key, Value, Augment>** node, bool* inserted,
+                                                             Args&&... args)
 {
     if (current == nullptr) {
+        *node = new Node<Key, Value, Augment>(key, std::forward<Args>(args)...);
+        *inserted = true;
         this->m_size++;
-        // Set the extra field of the new node to be the negative of the sum of the extra values on the path to its parent
-        Node<Key, Value>* temp = this->getRoot();
-        int sum = 0;
-        while (temp != nullptr) {
-            sum += temp->getExtra();
-            if (nodeToInsert->getKey() < temp->getKey()) {
-                temp = temp->getLeft();
-            } else if (nodeToInsert->getKey() > temp->getKey()) {
-                temp = temp->getRight();
-            } else {
-                break;
-            }
-        }
-        nodeToInsert->setExtra(-sum);
-        return nodeToInsert;
+        Augment::attached(this->getRoot(), *node);
+        Augment::update(*node);
+        return *node;
     }
 
-    if (nodeToInsert->getKey() < current->getKey()) {
-        current->setLeft(insert(nodeToInsert, current->getLeft(), doesExist));
-    } else if (nodeToInsert->getKey() > current->getKey()) {
-        current->setRight(insert(nodeToInsert, current->getRight(), doesExist));
+    if (key < current->getKey()) {
+        current->setLeft(insert(current->getLeft(), key, node, inserted, std::forward<Args>(args)...));
+    } else if (key > current->getKey()) {
+        current->setRight(insert(current->getRight(), key, node, inserted, std::forward<Args>(args)...));
     } else {
-        *doesExist = true;
-        delete nodeToInsert;
+        *node = current;
         return current;
     }
 
+    // nothing changed below an existing key
+    if (!*inserted)
+        return current;
     current = balance(current);
 
     return current;
 }
 
-template <class Key, class Value>
-bool Tree<Key, Value>::insert(const Key& key, const Value& value)
+template <class Key, class Value, class Augment>
+template <class... Args>
+std::pair<Value*, bool> Tree<Key, Value, Augment>::tryEmplace(const Key& key, Args&&... args)
 {
-    bool doesExist = false;
-    if (this->m_root == nullptr) {
-        this->m_root = new Node<Key, Value>(key, value);
-        this->m_minNode = unique_ptr<Node<Key, Value>>(new Node<Key, Value>(key, value));
-        this->m_size++;
-    }
-    else if (key == this->m_minNode->getKey()) {
-        return true;
-    }
-    else {
-        auto* node = new Node<Key, Value>(key, value);
-        if (key < this->m_minNode->getKey()) {
-            this->m_minNode = unique_ptr<Node<Key, Value>>(new Node<Key, Value>(key, value));
-        }
-        this->m_root = insert(node, this->m_root, &doesExist);
-    }
-    return doesExist;
+    Node<Key, Value, Augment>* node = nullptr;
+    bool inserted = false;
+    this->m_root = insert(this->m_root, key, &node, &inserted, std::forward<Args>(args)...);
+    return std::pair<Value*, bool>(&node->getValue(), inserted);
 }
 
-template <class Key, class Value>
-Node<Key, Value>* Tree<Key, Value>::remove(const Key& key, Node<Key, Value>* current, bool* doesExist)
+template <class Key, class Value, class Augment>
+template <class... Args>
+std::pair<Value*, bool> Tree<Key, Value, Augment>::emplace(const Key& key, Args&&... args)
+{
+    Value value(std::forward<Args>(args)...);
+    return tryEmplace(key, std::move(value));
+}
+
+template <class Key, class Value, class Augment>
+bool Tree<Key, Value, Augment>::insert(const Key& key, const Value& value)
+{
+    return !tryEmplace(key, value).second;
+}
+
+template <class Key, class Value, class Augment>
+Node<Key, Value, Augment>* Tree<Key, Value, Augment>::remove(const Key& key, Node<Key, Value, Augment>* current, bool* doesExist)
 {
     if (current == nullptr) {
         *doesExist = false;
@@ -485,7 +829,7 @@ Node<Key, Value>* Tree<Key, Value>::remove(const Key& key, Node<Key, Value>* cur
         // Case 1: One or No child
         if (current->getLeft() == nullptr || current->getRight() == nullptr)
         {
-            Node<Key, Value>* temp = current->getLeft() ? current->getLeft() : current->getRight();
+            Node<Key, Value, Augment>* temp = current->getLeft() ? current->getLeft() : current->getRight();
             // No child
             if (temp == nullptr) {
                 temp = current;
@@ -493,6 +837,7 @@ Node<Key, Value>* Tree<Key, Value>::remove(const Key& key, Node<Key, Value>* cur
             }
             // One child
             else {
+                Augment::spliced(current, temp);
                 *current = *temp;
             }
             delete temp;
@@ -501,11 +846,12 @@ Node<Key, Value>* Tree<Key, Value>::remove(const Key& key, Node<Key, Value>* cur
         // Case 2: Two children
         else
         {
-            Node<Key, Value>* temp = current->getRight();
+            Node<Key, Value, Augment>* temp = current->getRight();
             // Find node's successor to swap with
             while (temp->getLeft() != nullptr) {
                 temp = temp->getLeft();
             }
+            Augment::successorTaken(current, temp);
             current->setKey(temp->getKey());
             current->setValue(temp->getValue());
             current->setRight(remove(temp->getKey(), current->getRight(), doesExist));
@@ -516,17 +862,11 @@ Node<Key, Value>* Tree<Key, Value>::remove(const Key& key, Node<Key, Value>* cur
     return current;
 }
 
-template <class Key, class Value>
-bool Tree<Key, Value>::remove(const Key& key)
+template <class Key, class Value, class Augment>
+bool Tree<Key, Value, Augment>::remove(const Key& key)
 {
     bool doesExist = true;
     this->m_root = remove(key, this->m_root, &doesExist);
-    if (key == this->m_minNode->getKey()) {
-        Node<Key, Value>* temp = findMin(this->m_root);
-        if (temp != nullptr) {
-            this->m_minNode = unique_ptr<Node<Key, Value>>(new Node<Key, Value>(temp->getKey(), temp->getValue()));
-        }
-    }
     return doesExist;
 }
 
@@ -3,45 +3,133 @@
 //
 
 #include "UnionFind.h"
+#include "ConcurrentUnionFind.h"
+#include <new>
+#include <system_error>
+#include <thread>
 
 
-UnionFind::UnionFind() : m_stack(nullptr), m_parent(nullptr)
+UnionFind::UnionFind() : m_stack(nullptr), m_parent(nullptr), m_next(nullptr), m_size(0), m_capacity(0)
                           {}
 
 UnionFind::~UnionFind()
 {
     delete[] m_stack;
     delete[] m_parent;
+    delete[] m_next;
 }
 
 void UnionFind::init(const int* m_recordStocks, int number_of_m_record)
 {
+    releaseCheckpoints();
     delete[] m_stack;
     delete[] m_parent;
+    delete[] m_next;
+    m_stack = nullptr;
+    m_parent = nullptr;
+    m_next = nullptr;
+    m_size = 0;
+    m_capacity = 0;
     m_stack = new StackNode[number_of_m_record];
     m_parent = new int[number_of_m_record];
+    m_next = new int[number_of_m_record];
+    m_size = number_of_m_record;
+    m_capacity = number_of_m_record;
     for (int i = 0; i < number_of_m_record; ++i) {
         m_stack[i].m_height = m_recordStocks[i];
         m_stack[i].m_column = i;
+        m_stack[i].m_last = i;
         m_parent[i] = i;
+        m_next[i] = -1;
     }
 
 }
 
+//adds new singleton stacks after the existing records, existing stacks are left untouched
+void UnionFind::append(const int* recordsStocks, int numberOfRecords)
+{
+    if (m_size + numberOfRecords > m_capacity)
+        grow(m_size + numberOfRecords);
+
+    for (int i = 0; i < numberOfRecords; ++i) {
+        int id = m_size + i;
+        m_stack[id] = StackNode();
+        m_stack[id].m_height = recordsStocks[i];
+        m_stack[id].m_column = id;
+        m_stack[id].m_last = id;
+        m_parent[id] = id;
+        m_next[id] = -1;
+    }
+    m_size += numberOfRecords;
+}
+
+int UnionFind::getSize() const
+{
+    return m_size;
+}
+
+//doubles the capacity so a sequence of appends costs amortized O(1) per record
+void UnionFind::grow(int minCapacity)
+{
+    int newCapacity = m_capacity * 2;
+    if (newCapacity < minCapacity)
+        newCapacity = minCapacity;
+
+    StackNode* newStack = new StackNode[newCapacity];
+    int* newParent = nullptr;
+    int* newNext;
+    try {
+        newParent = new int[newCapacity];
+        newNext = new int[newCapacity];
+    } catch (std::bad_alloc& e) {
+        delete[] newStack;
+        delete[] newParent;
+        throw;
+    }
+    for (int i = 0; i < m_size; ++i) {
+        newStack[i] = m_stack[i];
+        newParent[i] = m_parent[i];
+        newNext[i] = m_next[i];
+    }
+    delete[] m_stack;
+    delete[] m_parent;
+    delete[] m_next;
+    m_stack = newStack;
+    m_parent = newParent;
+    m_next = newNext;
+    m_capacity = newCapacity;
+}
+
 //path compression find function
 int UnionFind::find(int id, int* relativeHeight)
 {
     int cur = id;
     int sum = 0;
+    RC_STATS_ONLY(int steps = 0;)
 
     while (m_parent[cur] != cur) {
         sum += m_stack[cur].m_r;
         cur = m_parent[cur];
+        RC_STATS_ONLY(steps++;)
     }
+#ifdef RC_STATS
+    m_findStats.m_finds++;
+    m_findStats.m_steps += steps;
+    m_findStats.m_paths.add(steps);
+    if (steps > m_findStats.m_maxPath)
+        m_findStats.m_maxPath = steps;
+#endif
 
     int root = cur;
     cur = id;
 
+    //paths are kept as they are while a checkpoint may need to undo unions
+    if (!m_checkpoints.empty()) {
+        if (relativeHeight != nullptr)
+            *relativeHeight = sum + m_stack[root].m_r;
+        return root;
+    }
+
     int toSubtract = 0;
     while (m_parent[cur] != cur) {
         int temp = m_stack[cur].m_r;
@@ -59,7 +147,7 @@ int UnionFind::find(int id, int* relativeHeight)
     return cur;
 }
 
-//weighted union function
+//union by rank function
 bool UnionFind::unionSets(int id1, int id2)
 {
     int B = find(id1, nullptr);
@@ -67,17 +155,29 @@ bool UnionFind::unionSets(int id1, int id2)
     if (B == A)
         return false;
 
+    if (!m_checkpoints.empty()) {
+        UnionRecord record;
+        record.m_bottom = A;
+        record.m_top = B;
+        record.m_bottomStack = m_stack[A];
+        record.m_topStack = m_stack[B];
+        m_undoLog.push_back(record);
+    }
+
+    //splice B's records after the top of A, before B takes A's column
+    m_next[m_stack[A].m_last] = m_stack[B].m_column;
     m_stack[B].m_column = m_stack[A].m_column;
 
     if (m_stack[A].m_rank >= m_stack[B].m_rank ) {
         m_parent[B] = A;
 
-        m_stack[A].m_rank++;
+        if (m_stack[A].m_rank == m_stack[B].m_rank)
+            m_stack[A].m_rank++;
         m_stack[B].m_r += m_stack[A].m_height - m_stack[A].m_r;
         m_stack[A].m_height += m_stack[B].m_height;
+        m_stack[A].m_last = m_stack[B].m_last;
     } else {
         m_parent[A] = B;
-        m_stack[B].m_rank++;
         m_stack[B].m_r += m_stack[A].m_height;
         m_stack[A].m_r -= m_stack[B].m_r;
         m_stack[B].m_height += m_stack[A].m_height;
@@ -94,3 +194,248 @@ std::pair<int, int> UnionFind::getPlace(int id) {
     return std::make_pair(column, relativeHeight);
 }
 
+//records of id's column from bottom to top
+void UnionFind::getColumn(int id, std::vector<int>* out)
+{
+    out->clear();
+    for (int cur = m_stack[find(id, nullptr)].m_column; cur != -1; cur = m_next[cur]) {
+        out->push_back(cur);
+    }
+}
+
+int UnionFind::checkpoint()
+{
+    m_checkpoints.push_back(m_undoLog.size());
+    return m_undoLog.size();
+}
+
+//undoes every union made after the checkpoint, the checkpoint itself stays usable
+bool UnionFind::rollbackTo(int checkpoint)
+{
+    while (!m_checkpoints.empty() && m_checkpoints.back() > checkpoint) {
+        m_checkpoints.pop_back();
+    }
+    if (m_checkpoints.empty() || m_checkpoints.back() != checkpoint)
+        return false;
+
+    while ((int)m_undoLog.size() > checkpoint) {
+        const UnionRecord& record = m_undoLog.back();
+        m_stack[record.m_bottom] = record.m_bottomStack;
+        m_stack[record.m_top] = record.m_topStack;
+        m_parent[record.m_bottom] = record.m_bottom;
+        m_parent[record.m_top] = record.m_top;
+        m_next[record.m_bottomStack.m_last] = -1;
+        m_undoLog.pop_back();
+    }
+    return true;
+}
+
+//keeps the current stacks and goes back to path compression
+void UnionFind::releaseCheckpoints()
+{
+    m_undoLog.clear();
+    m_checkpoints.clear();
+}
+
+bool UnionFind::hasCheckpoints() const
+{
+    return !m_checkpoints.empty();
+}
+
+static void runUnions(ConcurrentUnionFind* concurrent, const int* tops, const int* bottoms, int count, int first,
+                      int step, int* tickets)
+{
+    for (int i = first; i < count; i += step) {
+        if (!concurrent->unionSets(tops[i], bottoms[i], &tickets[i]))
+            tickets[i] = -1;
+    }
+}
+
+void UnionFind::unionSetsParallel(const int* tops, const int* bottoms, int count, int threads, int* tickets)
+{
+    //the concurrent structure keeps the bottom record as the root of every column
+    ConcurrentUnionFind concurrent;
+    concurrent.reset(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        int height;
+        int root = find(i, &height);
+        int column = m_stack[root].m_column;
+        concurrent.setRecord(i, column, height, m_next[i]);
+        if (i == column)
+            concurrent.setColumn(column, m_stack[root].m_height, m_stack[root].m_last);
+    }
+
+    //the calling thread takes a share too, so a failed thread start only means less parallelism
+    std::vector<std::thread> workers;
+    int step = threads < 1 ? 1 : threads;
+    int started = 1;
+    try {
+        workers.reserve(step - 1);
+        for (; started < step; ++started) {
+            workers.emplace_back(runUnions, &concurrent, tops, bottoms, count, started, step, tickets);
+        }
+    } catch (std::system_error& e) {
+    } catch (std::bad_alloc& e) {
+    }
+    runUnions(&concurrent, tops, bottoms, count, 0, step, tickets);
+    //shares of threads that never started
+    for (int first = started; first < step; ++first) {
+        runUnions(&concurrent, tops, bottoms, count, first, step, tickets);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    //every column comes back as a star rooted at its bottom record
+    for (int i = 0; i < m_size; ++i) {
+        std::pair<int, int> place = concurrent.getPlace(i);
+        m_stack[i] = StackNode();
+        m_stack[i].m_column = place.first;
+        m_stack[i].m_r = place.second;
+        m_parent[i] = place.first;
+        m_next[i] = concurrent.getNext(i);
+    }
+    for (int i = 0; i < m_size; ++i) {
+        if (m_parent[i] == i) {
+            m_stack[i].m_height = concurrent.getColumnHeight(i);
+            m_stack[i].m_last = concurrent.getLast(i);
+        } else {
+            m_stack[m_parent[i]].m_rank = 1;
+        }
+    }
+}
+
+FindStats UnionFind::getFindStats() const
+{
+#ifdef RC_STATS
+    return m_findStats;
+#else
+    return FindStats();
+#endif
+}
+
+size_t UnionFind::stackBytes() const
+{
+    return m_capacity * (sizeof(StackNode) + 2 * sizeof(int));
+}
+
+size_t UnionFind::undoLogBytes() const
+{
+    return m_undoLog.capacity() * sizeof(UnionRecord) + m_checkpoints.capacity() * sizeof(int);
+}
+
+void UnionFind::save(SnapshotWriter& writer) const
+{
+    writer.write(m_size);
+    writer.writeArray(m_stack, m_size);
+    writer.writeArray(m_parent, m_size);
+    writer.writeArray(m_next, m_size);
+    //open checkpoints, so a rollback after loading undoes the same unions
+    writer.write((int) m_undoLog.size());
+    writer.writeArray(m_undoLog.data(), m_undoLog.size());
+    writer.write((int) m_checkpoints.size());
+    writer.writeArray(m_checkpoints.data(), m_checkpoints.size());
+}
+
+bool UnionFind::load(SnapshotReader& reader)
+{
+    int size;
+    if (!reader.read(&size) || size < 0 ||
+        (size_t) size > reader.remaining() / (sizeof(StackNode) + 2 * sizeof(int)))
+        return false;
+
+    int* stocks = new int[size];
+    for (int i = 0; i < size; ++i) {
+        stocks[i] = 0;
+    }
+    try {
+        init(stocks, size);
+    } catch (std::bad_alloc& e) {
+        delete[] stocks;
+        throw;
+    }
+    delete[] stocks;
+
+    if (!reader.readArray(m_stack, size) || !reader.readArray(m_parent, size) || !reader.readArray(m_next, size))
+        return false;
+    for (int i = 0; i < size; ++i) {
+        if (m_parent[i] < 0 || m_parent[i] >= size || m_next[i] < -1 || m_next[i] >= size)
+            return false;
+        if (m_parent[i] == i && (m_stack[i].m_column < 0 || m_stack[i].m_column >= size ||
+                                 m_stack[i].m_last < 0 || m_stack[i].m_last >= size))
+            return false;
+    }
+    if (!isForest() || !nextChainsEnd())
+        return false;
+
+    int undoCount, checkpointCount;
+    if (!reader.read(&undoCount) || undoCount < 0 || (size_t) undoCount > reader.remaining() / sizeof(UnionRecord))
+        return false;
+    m_undoLog.resize(undoCount);
+    if (!reader.readArray(m_undoLog.data(), undoCount))
+        return false;
+    //rollbackTo restores these stacks as roots and ends the bottom one's column
+    for (const UnionRecord& record : m_undoLog) {
+        if (record.m_bottom < 0 || record.m_bottom >= size || record.m_top < 0 || record.m_top >= size ||
+            record.m_bottomStack.m_last < 0 || record.m_bottomStack.m_last >= size ||
+            record.m_bottomStack.m_column < 0 || record.m_bottomStack.m_column >= size ||
+            record.m_topStack.m_last < 0 || record.m_topStack.m_last >= size ||
+            record.m_topStack.m_column < 0 || record.m_topStack.m_column >= size)
+            return false;
+    }
+    if (!reader.read(&checkpointCount) || checkpointCount < 0 ||
+        (size_t) checkpointCount > reader.remaining() / sizeof(int))
+        return false;
+    m_checkpoints.resize(checkpointCount);
+    if (!reader.readArray(m_checkpoints.data(), checkpointCount))
+        return false;
+    for (int i = 0; i < checkpointCount; ++i) {
+        if (m_checkpoints[i] < 0 || m_checkpoints[i] > undoCount ||
+            (i > 0 && m_checkpoints[i] < m_checkpoints[i - 1]))
+            return false;
+    }
+    return true;
+}
+
+//every parent chain reaches a root, each record is walked once
+bool UnionFind::isForest() const
+{
+    //0 not seen, 1 on the chain being walked, 2 known to reach a root
+    std::vector<char> state(m_size, 0);
+    for (int i = 0; i < m_size; ++i) {
+        int cur = i;
+        while (state[cur] == 0 && m_parent[cur] != cur) {
+            state[cur] = 1;
+            cur = m_parent[cur];
+        }
+        if (state[cur] == 1)
+            return false;
+        for (cur = i; state[cur] != 2; cur = m_parent[cur]) {
+            state[cur] = 2;
+        }
+    }
+    return true;
+}
+
+//every next chain ends in -1, so no column loops or merges into another
+bool UnionFind::nextChainsEnd() const
+{
+    std::vector<char> hasPrevious(m_size, 0);
+    for (int i = 0; i < m_size; ++i) {
+        if (m_next[i] == -1)
+            continue;
+        if (hasPrevious[m_next[i]])
+            return false;
+        hasPrevious[m_next[i]] = 1;
+    }
+    //walking from every chain's first record must reach each record, the rest lie on cycles
+    int reached = 0;
+    for (int i = 0; i < m_size; ++i) {
+        if (hasPrevious[i])
+            continue;
+        for (int cur = i; cur != -1; cur = m_next[cur]) {
+            reached++;
+        }
+    }
+    return reached == m_size;
+}
@@ -6,16 +6,30 @@
 #define WET2_UNIONFIND_H
 
 #include <utility>
+#include <vector>
+#include "Stats.h"
+#include "Snapshot.h"
 
 class StackNode {
 public:
-    StackNode() : m_column(-1), m_height(0), m_rank(0), m_r(0) {}
-    //fake column to return to user
+    StackNode() : m_column(-1), m_height(0), m_rank(0), m_r(0), m_last(-1) {}
+    //fake column to return to user, it's also the bottom record of the column
     int m_column;
     int m_height;
     //real height for union to use
     int m_rank;
     int m_r;
+    //top record of the column, valid on the root only
+    int m_last;
+};
+
+//state of the two roots touched by a single union, used to undo it
+class UnionRecord {
+public:
+    int m_bottom;
+    int m_top;
+    StackNode m_bottomStack;
+    StackNode m_topStack;
 };
 
 class UnionFind {
@@ -23,13 +37,52 @@ public:
     UnionFind();
     ~UnionFind();
     void init(const int* recordsStocks, int numberOfRecords);
+    void append(const int* recordsStocks, int numberOfRecords);
+    int getSize() const;
     int find(int id, int* relativeHeight);
     bool unionSets(int id1, int id2);
     std::pair<int, int> getPlace(int id);
+    void getColumn(int id, std::vector<int>* out);
+    /*
+     * While a checkpoint exists find doesn't compress paths and every union is logged,
+     * so rolling back costs O(1) per undone union.
+     */
+    int checkpoint();
+    bool rollbackTo(int checkpoint);
+    void releaseCheckpoints();
+    bool hasCheckpoints() const;
+    /*
+     * Runs unionSets(tops[i], bottoms[i]) for all i on threads threads through a ConcurrentUnionFind.
+     * tickets[i] is -1 for a failed union, otherwise its place in a sequential order of the successful
+     * unions that builds the same stacks. Unions on disjoint columns end up as if run in index order.
+     * Costs O(n) to copy the stacks in and out, so it pays off for large batches. No checkpoints may be open.
+     */
+    void unionSetsParallel(const int* tops, const int* bottoms, int count, int threads, int* tickets);
+    //path lengths seen by find, empty without RC_STATS
+    FindStats getFindStats() const;
+    //bytes of the stacks, parents and next links, and of the undo log with its checkpoints
+    size_t stackBytes() const;
+    size_t undoLogBytes() const;
+    //open checkpoints are saved too, so rollbackTo works after load
+    void save(SnapshotWriter& writer) const;
+    bool load(SnapshotReader& reader);
 private:
     StackNode* m_stack;
     //contains an actual parent
     int* m_parent;
+    //next record up the column, -1 for the top one
+    int* m_next;
+    int m_size;
+    int m_capacity;
+    std::vector<UnionRecord> m_undoLog;
+    std::vector<int> m_checkpoints;
+#ifdef RC_STATS
+    FindStats m_findStats;
+#endif
+    void grow(int minCapacity);
+    //structural checks for a loaded snapshot
+    bool isForest() const;
+    bool nextChainsEnd() const;
 };
 
 
@@ -0,0 +1,139 @@
+#include "WriteAheadLog.h"
+#include <cstring>
+#include <unistd.h>
+
+//the last byte is the format version, 2 since amounts are stored in cents
+static const char LOG_MAGIC[4] = {'R', 'C', 'W', '2'};
+
+WriteAheadLog::WriteAheadLog() : m_file(nullptr), m_writer(nullptr), m_durability(DURABILITY_GROUP), m_groupSize(1),
+                                 m_pending(0), m_failed(false), m_generation(0), m_start(0)
+{}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    close();
+}
+
+bool WriteAheadLog::readHeader(FILE* file, uint32_t* generation)
+{
+    char magic[sizeof(LOG_MAGIC)];
+    return fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, LOG_MAGIC, sizeof(magic)) == 0 &&
+           fread(generation, sizeof(*generation), 1, file) == 1;
+}
+
+bool WriteAheadLog::writeHeader()
+{
+    return fwrite(LOG_MAGIC, 1, sizeof(LOG_MAGIC), m_file) == sizeof(LOG_MAGIC) &&
+           fwrite(&m_generation, sizeof(m_generation), 1, m_file) == 1 && fflush(m_file) == 0 &&
+           fsync(fileno(m_file)) == 0;
+}
+
+bool WriteAheadLog::open(const std::string& path, Durability durability, int groupSize, uint32_t newGeneration)
+{
+    close();
+    m_generation = newGeneration;
+    bool hasHeader = false;
+    FILE* existing = fopen(path.c_str(), "rb");
+    if (existing != nullptr) {
+        hasHeader = readHeader(existing, &m_generation);
+        fclose(existing);
+        if (!hasHeader)
+            m_generation = newGeneration;
+    }
+
+    //always appending, so writes after truncate() land at the new end of the file
+    m_file = fopen(path.c_str(), "ab");
+    if (m_file == nullptr)
+        return false;
+    if (!hasHeader && (ftruncate(fileno(m_file), 0) != 0 || !writeHeader())) {
+        fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_writer = new CommandLogWriter(m_file);
+    m_durability = durability;
+    m_groupSize = groupSize < 1 ? 1 : groupSize;
+    m_pending = 0;
+    m_failed = false;
+    //records already in the file belong to this generation too
+    m_start = 0;
+    if (hasHeader && fseek(m_file, 0, SEEK_END) == 0)
+        m_start = (long long) sizeof(LOG_MAGIC) + (long long) sizeof(m_generation) - ftell(m_file);
+    return true;
+}
+
+void WriteAheadLog::close()
+{
+    if (m_file == nullptr)
+        return;
+    commit();
+    delete m_writer;
+    m_writer = nullptr;
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+bool WriteAheadLog::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+uint32_t WriteAheadLog::getGeneration() const
+{
+    return m_generation;
+}
+
+long long WriteAheadLog::size() const
+{
+    return m_writer == nullptr ? 0 : m_writer->size() - m_start;
+}
+
+void WriteAheadLog::append(OpCode op, int arg0, int arg1, Money amount)
+{
+    m_record.m_op = op;
+    m_record.m_args[0] = arg0;
+    m_record.m_args[1] = arg1;
+    m_record.m_amount = amount;
+    m_writer->append(m_record);
+    appended();
+}
+
+void WriteAheadLog::appendStocks(OpCode op, const int* stocks, int count)
+{
+    //written straight from the caller's array, a copy could fail after the state already changed
+    m_writer->appendStocks(op, stocks, count);
+    appended();
+}
+
+void WriteAheadLog::appended()
+{
+    m_pending++;
+    if (m_durability == DURABILITY_SYNC || (m_durability == DURABILITY_GROUP && m_pending >= m_groupSize))
+        commit();
+}
+
+bool WriteAheadLog::commit()
+{
+    if (m_file == nullptr)
+        return false;
+    m_writer->flush();
+    if (ferror(m_file))
+        m_failed = true;
+    if (m_durability != DURABILITY_NONE && m_pending > 0 && fsync(fileno(m_file)) != 0)
+        m_failed = true;
+    m_pending = 0;
+    return !m_failed;
+}
+
+bool WriteAheadLog::truncate()
+{
+    if (!commit())
+        return false;
+    m_generation++;
+    if (ftruncate(fileno(m_file), 0) != 0 || !writeHeader()) {
+        m_failed = true;
+        return false;
+    }
+    m_start = m_writer->size();
+    return true;
+}
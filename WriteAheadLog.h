@@ -0,0 +1,63 @@
+#ifndef WET2_WRITEAHEADLOG_H
+#define WET2_WRITEAHEADLOG_H
+
+#include "CommandLog.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+typedef enum Durability_t {
+    //records reach the file when the buffer fills or on commit, never synced
+    DURABILITY_NONE,
+    //synced once every group of records and on commit
+    DURABILITY_GROUP,
+    //synced after every record
+    DURABILITY_SYNC
+} Durability;
+
+/*
+ * Append-only log of mutating commands: a header with the log's generation followed by
+ * records in the binary command log format. Records are buffered and synced in groups so
+ * the cost of fsync is shared by many operations. Truncating the log starts a new generation,
+ * which lets recovery tell whether a snapshot already covers the records.
+ */
+class WriteAheadLog {
+public:
+    WriteAheadLog();
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog& other) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog& other) = delete;
+    //appends to an existing log, a new or empty file starts with the given generation
+    bool open(const std::string& path, Durability durability, int groupSize, uint32_t newGeneration);
+    void close();
+    bool isOpen() const;
+    uint32_t getGeneration() const;
+    //bytes of records appended in this generation, including the ones not written yet
+    long long size() const;
+    void append(OpCode op, int arg0 = 0, int arg1 = 0, Money amount = 0);
+    void appendStocks(OpCode op, const int* stocks, int count);
+    //writes the buffered records and syncs them, false on an I/O error
+    bool commit();
+    //drops every record and starts the next generation, used once a snapshot covers them
+    bool truncate();
+    //reads the header of a log file, false if the file has no complete header
+    static bool readHeader(FILE* file, uint32_t* generation);
+private:
+    FILE* m_file;
+    CommandLogWriter* m_writer;
+    //reused for every record so logging doesn't allocate
+    Command m_record;
+    Durability m_durability;
+    int m_groupSize;
+    int m_pending;
+    bool m_failed;
+    uint32_t m_generation;
+    //m_writer's size when the current generation started
+    long long m_start;
+
+    void appended();
+    bool writeHeader();
+};
+
+
+#endif //WET2_WRITEAHEADLOG_H
@@ -0,0 +1,211 @@
+#include "WorkloadGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+WorkloadConfig::WorkloadConfig() : m_customers(100000), m_records(100000), m_operations(1000000), m_members(0.5),
+                                   m_distribution(DIST_UNIFORM), m_zipfExponent(0.99), m_prizeWidth(1000), m_seed(1),
+                                   m_mix(OP_UNKNOWN, 0)
+{
+    m_mix[OP_ADD_COSTUMER] = 5;
+    m_mix[OP_GET_PHONE] = 15;
+    m_mix[OP_MAKE_MEMBER] = 5;
+    m_mix[OP_IS_MEMBER] = 15;
+    m_mix[OP_BUY_RECORD] = 20;
+    m_mix[OP_ADD_PRIZE] = 5;
+    m_mix[OP_GET_EXPENSES] = 15;
+    m_mix[OP_PUT_ON_TOP] = 10;
+    m_mix[OP_GET_PLACE] = 10;
+    m_mix[OP_ADD_RECORDS] = 1;
+    m_mix[OP_GET_CUSTOMER_BY_PHONE] = 5;
+    m_mix[OP_REMOVE_CUSTOMER] = 1;
+    m_mix[OP_REVOKE_MEMBERSHIP] = 1;
+}
+
+//mix is a comma separated list of op:weight, opcodes not listed get weight 0
+static bool parseMix(const std::string& value, std::vector<double>* mix)
+{
+    mix->assign(OP_UNKNOWN, 0);
+    std::stringstream list(value);
+    std::string entry;
+    while (std::getline(list, entry, ',')) {
+        size_t colon = entry.find(':');
+        if (colon == std::string::npos)
+            return false;
+        OpCode op = decodeOpCode(entry.data(), colon);
+        if (op == OP_UNKNOWN)
+            return false;
+        (*mix)[op] = atof(entry.c_str() + colon + 1);
+    }
+    return true;
+}
+
+bool WorkloadConfig::parse(const std::string& argument)
+{
+    size_t equals = argument.find('=');
+    if (equals == std::string::npos)
+        return false;
+    std::string key = argument.substr(0, equals);
+    std::string value = argument.substr(equals + 1);
+
+    if (key == "customers")
+        m_customers = atoi(value.c_str());
+    else if (key == "records")
+        m_records = atoi(value.c_str());
+    else if (key == "ops")
+        m_operations = atoi(value.c_str());
+    else if (key == "members")
+        m_members = atof(value.c_str());
+    else if (key == "zipf")
+        m_zipfExponent = atof(value.c_str());
+    else if (key == "prize_width")
+        m_prizeWidth = atoi(value.c_str());
+    else if (key == "seed")
+        m_seed = atoi(value.c_str());
+    else if (key == "mix")
+        return parseMix(value, &m_mix);
+    else if (key == "dist") {
+        if (value == "uniform")
+            m_distribution = DIST_UNIFORM;
+        else if (value == "zipf")
+            m_distribution = DIST_ZIPFIAN;
+        else if (value == "seq")
+            m_distribution = DIST_SEQUENTIAL;
+        else
+            return false;
+    }
+    else
+        return false;
+    return m_customers > 0 && m_records > 0 && m_operations >= 0 && m_prizeWidth > 0;
+}
+
+IdGenerator::IdGenerator(int n, Distribution distribution, double zipfExponent) : m_n(n),
+                                                                                  m_distribution(distribution),
+                                                                                  m_sequence(0)
+{
+    if (distribution != DIST_ZIPFIAN)
+        return;
+    m_cdf.resize(n);
+    double sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += 1.0 / std::pow(i + 1, zipfExponent);
+        m_cdf[i] = sum;
+    }
+    for (int i = 0; i < n; ++i) {
+        m_cdf[i] /= sum;
+    }
+}
+
+int IdGenerator::next(std::mt19937& random)
+{
+    switch (m_distribution) {
+        case DIST_SEQUENTIAL:
+            m_sequence = m_sequence + 1 == m_n ? 0 : m_sequence + 1;
+            return m_sequence;
+        case DIST_ZIPFIAN: {
+            double p = std::uniform_real_distribution<double>(0, 1)(random);
+            int rank = std::lower_bound(m_cdf.begin(), m_cdf.end(), p) - m_cdf.begin();
+            if (rank >= m_n)
+                rank = m_n - 1;
+            return (int) (((long long) rank * 2654435761LL) % m_n);
+        }
+        default:
+            return std::uniform_int_distribution<int>(0, m_n - 1)(random);
+    }
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& config) : m_config(config), m_random(config.m_seed),
+                                                                   m_customerIds(config.m_customers,
+                                                                                 config.m_distribution,
+                                                                                 config.m_zipfExponent),
+                                                                   m_recordIds(config.m_records,
+                                                                               config.m_distribution,
+                                                                               config.m_zipfExponent),
+                                                                   m_ops(config.m_mix.begin(), config.m_mix.end())
+{}
+
+void WorkloadGenerator::stocks(Command* command, int count)
+{
+    command->m_stocks.resize(count);
+    for (int i = 0; i < count; ++i) {
+        command->m_stocks[i] = std::uniform_int_distribution<int>(0, 100)(m_random);
+    }
+}
+
+void WorkloadGenerator::setup(std::vector<Command>* commands)
+{
+    Command command;
+    command.m_op = OP_NEW_MONTH;
+    stocks(&command, m_config.m_records);
+    commands->push_back(command);
+
+    command.m_stocks.clear();
+    for (int i = 0; i < m_config.m_customers; ++i) {
+        command.m_op = OP_ADD_COSTUMER;
+        command.m_args[0] = i;
+        command.m_args[1] = std::uniform_int_distribution<int>(0, 999999999)(m_random);
+        m_phones.push_back(command.m_args[1]);
+        commands->push_back(command);
+    }
+    for (int i = 0; i < m_config.m_customers; ++i) {
+        if (std::uniform_real_distribution<double>(0, 1)(m_random) >= m_config.m_members)
+            continue;
+        command.m_op = OP_MAKE_MEMBER;
+        command.m_args[0] = i;
+        commands->push_back(command);
+    }
+}
+
+void WorkloadGenerator::generate(std::vector<Command>* commands)
+{
+    Command command;
+    for (int i = 0; i < m_config.m_operations; ++i) {
+        command.m_op = (OpCode) m_ops(m_random);
+        switch (command.m_op) {
+            case OP_NEW_MONTH:
+            case OP_ADD_RECORDS:
+                stocks(&command, command.m_op == OP_NEW_MONTH ? m_config.m_records : 1);
+                break;
+            case OP_ADD_COSTUMER:
+                //mostly new ids, the rest hit existing customers
+                command.m_args[0] = std::uniform_int_distribution<int>(0, 2 * m_config.m_customers)(m_random);
+                command.m_args[1] = std::uniform_int_distribution<int>(0, 999999999)(m_random);
+                break;
+            case OP_BUY_RECORD:
+                command.m_args[0] = m_customerIds.next(m_random);
+                command.m_args[1] = m_recordIds.next(m_random);
+                break;
+            case OP_ADD_PRIZE: {
+                int first = m_customerIds.next(m_random);
+                command.m_args[0] = first;
+                command.m_args[1] = first + std::uniform_int_distribution<int>(1, m_config.m_prizeWidth)(m_random);
+                command.m_amount = std::uniform_int_distribution<int>(1, 100)(m_random) * CENTS_PER_UNIT;
+                break;
+            }
+            case OP_PUT_ON_TOP:
+                command.m_args[0] = m_recordIds.next(m_random);
+                command.m_args[1] = m_recordIds.next(m_random);
+                break;
+            case OP_GET_PLACE:
+                command.m_args[0] = m_recordIds.next(m_random);
+                break;
+            case OP_GET_CUSTOMER_BY_PHONE: {
+                //phones of the setup's customers, so most lookups hit
+                int c_id = m_customerIds.next(m_random);
+                command.m_args[0] = c_id < (int) m_phones.size() ? m_phones[c_id] : c_id;
+                break;
+            }
+            case OP_ROLLBACK_TO:
+                //the first checkpoint after a release is always 0
+                command.m_args[0] = 0;
+                break;
+            default:
+                command.m_args[0] = m_customerIds.next(m_random);
+                break;
+        }
+        command.m_word = opCodeName(command.m_op);
+        commands->push_back(command);
+        command.m_stocks.clear();
+    }
+}
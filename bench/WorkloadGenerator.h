@@ -0,0 +1,67 @@
+#ifndef WET2_WORKLOADGENERATOR_H
+#define WET2_WORKLOADGENERATOR_H
+
+#include "../CommandParser.h"
+#include <random>
+#include <string>
+#include <vector>
+
+typedef enum Distribution_t {
+    DIST_UNIFORM,
+    DIST_ZIPFIAN,
+    DIST_SEQUENTIAL
+} Distribution;
+
+class WorkloadConfig {
+public:
+    WorkloadConfig();
+    //parses "key=value" arguments, false on an unknown key or value
+    bool parse(const std::string& argument);
+
+    int m_customers;
+    int m_records;
+    int m_operations;
+    //fraction of the customers made members before the run
+    double m_members;
+    Distribution m_distribution;
+    double m_zipfExponent;
+    //width of the addPrize customer id range
+    int m_prizeWidth;
+    unsigned m_seed;
+    //relative weight of every opcode, indexed by OpCode
+    std::vector<double> m_mix;
+};
+
+//draws ids in [0, n) with the configured distribution
+class IdGenerator {
+public:
+    IdGenerator(int n, Distribution distribution, double zipfExponent);
+    int next(std::mt19937& random);
+private:
+    int m_n;
+    Distribution m_distribution;
+    int m_sequence;
+    //cumulative zipf probabilities, rank i is mapped to a scattered id so hot ids don't share buckets
+    std::vector<double> m_cdf;
+};
+
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& config);
+    //initial newMonth plus the customers and members the run starts with
+    void setup(std::vector<Command>* commands);
+    void generate(std::vector<Command>* commands);
+private:
+    const WorkloadConfig& m_config;
+    std::mt19937 m_random;
+    IdGenerator m_customerIds;
+    IdGenerator m_recordIds;
+    std::discrete_distribution<int> m_ops;
+    //phones of the setup's customers, by id
+    std::vector<int> m_phones;
+
+    void stocks(Command* command, int count);
+};
+
+
+#endif //WET2_WORKLOADGENERATOR_H
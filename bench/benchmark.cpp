@@ -0,0 +1,399 @@
+#include "../recordsCompany.h"
+#include "../CommandExecutor.h"
+#include "../StoreHost.h"
+#include "WorkloadGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Per-operation throughput and latency percentiles of RecordsCompany.
+ * Usage: benchmark [customers=N] [records=N] [ops=N] [members=F] [dist=uniform|zipf|seq] [zipf=S]
+ *                  [prize_width=N] [seed=N] [mix=op:weight,...] [batch=N] [memory] [archive] [cache=N]
+ *                  [stores=N] [workers=N]
+ * With batch=N it instead compares ops lookups done one by one with getPhone / isMember
+ * against the same lookups done N at a time with getPhoneBatch / isMemberBatch.
+ * With memory it reports RecordsCompany::memoryUsage after the setup, per customer, member and record.
+ * With archive it seals the month the run leaves, saves and loads it back, checks that the loaded
+ * archive scans the same values and reports the archive's size and the time of every step.
+ * cache=N turns on the customer cache with N entries and reports its hit rate after the run.
+ * With stores=N it runs the workload on each of N stores of a StoreHost with workers threads
+ * (default 1), in batches of HOST_BATCH commands per store, and reports the total throughput.
+ * After the mix, methods that have no command get their own loop of ops / EXTRA_DIVISOR calls:
+ * getColumn, topSellers, topSpenders, checkpoint / rollbackTo / releaseCheckpoints around a putOnTop,
+ * and putOnTopBatch on workers threads, timed per pair.
+ * Build (from the repository root):
+ *   g++ -std=c++11 -O2 -DNDEBUG -pthread bench/benchmark.cpp bench/WorkloadGenerator.cpp \
+ *       $(ls *.cpp | grep -v mainWet2) -o benchmark
+ */
+
+typedef chrono::steady_clock Clock;
+
+static long long nanoseconds(Clock::time_point from, Clock::time_point to)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(to - from).count();
+}
+
+static long long percentile(const vector<long long>& sorted, double p)
+{
+    size_t index = (size_t) (p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+static void reportLookups(const char* name, size_t count, long long total)
+{
+    printf("%-16s %10zu %12.0f\n", name, count, count * 1e9 / (total > 0 ? total : 1));
+}
+
+static int runBatchLookups(RecordsCompany* company, const WorkloadConfig& config, int batch)
+{
+    mt19937 random(config.m_seed);
+    IdGenerator ids(config.m_customers, config.m_distribution, config.m_zipfExponent);
+    vector<int> keys(config.m_operations);
+    for (int& key : keys) {
+        key = ids.next(random);
+    }
+    vector<int> phones(keys.size());
+    vector<bool> singleMembers(keys.size());
+    unique_ptr<bool[]> members(new bool[keys.size()]);
+    vector<StatusType> statuses(keys.size());
+
+    printf("%-16s %10s %12s\n", "lookup", "count", "ops/s");
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        phones[i] = company->getPhone(keys[i]).ans();
+    }
+    reportLookups("getPhone", keys.size(), nanoseconds(start, Clock::now()));
+    long long phoneSum = 0;
+    for (int phone : phones) {
+        phoneSum += phone;
+    }
+
+    start = Clock::now();
+    for (size_t i = 0; i < keys.size(); i += batch) {
+        int count = (int) min((size_t) batch, keys.size() - i);
+        company->getPhoneBatch(keys.data() + i, count, phones.data() + i, statuses.data() + i);
+    }
+    reportLookups("getPhoneBatch", keys.size(), nanoseconds(start, Clock::now()));
+    for (int phone : phones) {
+        phoneSum -= phone;
+    }
+
+    start = Clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        singleMembers[i] = company->isMember(keys[i]).ans();
+    }
+    reportLookups("isMember", keys.size(), nanoseconds(start, Clock::now()));
+
+    start = Clock::now();
+    for (size_t i = 0; i < keys.size(); i += batch) {
+        int count = (int) min((size_t) batch, keys.size() - i);
+        company->isMemberBatch(keys.data() + i, count, members.get() + i, statuses.data() + i);
+    }
+    reportLookups("isMemberBatch", keys.size(), nanoseconds(start, Clock::now()));
+
+    bool same = phoneSum == 0;
+    for (size_t i = 0; i < keys.size() && same; ++i) {
+        same = singleMembers[i] == members[i];
+    }
+    if (!same) {
+        fprintf(stderr, "batch lookups disagree with single lookups\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void reportBytes(const char* name, size_t bytes, const char* unit, int count)
+{
+    printf("%-16s %12zu %10.1f per %s\n", name, bytes, count > 0 ? (double) bytes / count : 0.0, unit);
+}
+
+static void runMemory(RecordsCompany* company)
+{
+    CompanyStats stats = company->stats();
+    const MemoryUsage& memory = stats.m_memory;
+    int customers = stats.m_customers.m_size;
+    printf("%-16s %12s\n", "part", "bytes");
+    reportBytes("customer_buckets", memory.m_customerBuckets, "customer", customers);
+    reportBytes("customer_nodes", memory.m_customerNodes, "customer", customers);
+    reportBytes("customers", memory.m_customers, "customer", customers);
+    reportBytes("member_nodes", memory.m_memberNodes, "member", stats.m_members);
+    reportBytes("phone_index", memory.m_phoneIndex, "customer", customers);
+    reportBytes("sales", memory.m_sales, "record", stats.m_records);
+    reportBytes("stacks", memory.m_stacks, "record", stats.m_records);
+    reportBytes("undo_log", memory.m_undoLog, "record", stats.m_records);
+    reportBytes("per_customer", memory.m_customerBuckets + memory.m_customerNodes + memory.m_customers +
+                memory.m_phoneIndex, "customer", customers);
+    reportBytes("per_record", memory.m_sales + memory.m_stacks + memory.m_undoLog, "record", stats.m_records);
+    reportBytes("total", memory.total(), "customer", customers);
+}
+
+static const char* ARCHIVE_PATH = "benchmark-archive.rca";
+
+static int runArchive(RecordsCompany* company, int records)
+{
+    vector<int> stocks(records, 1);
+    company->setArchiving(ARCHIVE_MEMORY);
+    Clock::time_point start = Clock::now();
+    company->newMonth(stocks.data(), records);
+    long long seal = nanoseconds(start, Clock::now());
+    shared_ptr<const MonthArchive> archive;
+    if (company->lastArchiveStatus() != SUCCESS || company->getArchive(0, &archive) != SUCCESS) {
+        fprintf(stderr, "sealing the month failed\n");
+        return -1;
+    }
+
+    start = Clock::now();
+    bool saved = archive->save(ARCHIVE_PATH);
+    long long save = nanoseconds(start, Clock::now());
+    MonthArchive loaded;
+    start = Clock::now();
+    bool read = saved && loaded.load(ARCHIVE_PATH);
+    long long load = nanoseconds(start, Clock::now());
+    remove(ARCHIVE_PATH);
+    if (!read) {
+        fprintf(stderr, "archive save / load failed\n");
+        return -1;
+    }
+
+    vector<pair<int, Money>> expenses, loadedExpenses;
+    vector<int> sales, loadedSales;
+    archive->scanExpenses([&expenses](int c_id, Money amount) { expenses.push_back(make_pair(c_id, amount)); });
+    archive->scanSales([&sales](int, int count) { sales.push_back(count); });
+    start = Clock::now();
+    loaded.scanExpenses([&loadedExpenses](int c_id, Money amount) {
+        loadedExpenses.push_back(make_pair(c_id, amount));
+    });
+    long long scanExpenses = nanoseconds(start, Clock::now());
+    start = Clock::now();
+    loaded.scanSales([&loadedSales](int, int count) { loadedSales.push_back(count); });
+    long long scanSales = nanoseconds(start, Clock::now());
+    if (expenses != loadedExpenses || sales != loadedSales || loaded.byteSize() != archive->byteSize()) {
+        fprintf(stderr, "loaded archive differs from the sealed one\n");
+        return -1;
+    }
+
+    printf("archive: %d members, %d records, %zu bytes, seal %.3f ms, save %.3f ms, load %.3f ms, "
+           "scanExpenses %.3f ms, scanSales %.3f ms\n", loaded.memberCount(), loaded.recordCount(),
+           loaded.byteSize(), seal / 1e6, save / 1e6, load / 1e6, scanExpenses / 1e6, scanSales / 1e6);
+    return 0;
+}
+
+static const int HOST_BATCH = 256;
+
+//runs commands on every store, interleaved in batches, returns the nanoseconds spent in executeBatch
+static long long runOnStores(StoreHost* host, int stores, const vector<Command>& commands)
+{
+    vector<int> storeIds;
+    vector<Command> batch;
+    vector<CommandResult> results;
+    long long total = 0;
+    for (size_t start = 0; start < commands.size(); start += HOST_BATCH) {
+        size_t end = min(commands.size(), start + HOST_BATCH);
+        storeIds.clear();
+        batch.clear();
+        for (int store = 0; store < stores; ++store) {
+            for (size_t i = start; i < end; ++i) {
+                storeIds.push_back(store);
+                batch.push_back(commands[i]);
+            }
+        }
+        results.resize(batch.size());
+        Clock::time_point before = Clock::now();
+        host->executeBatch(storeIds.data(), batch.data(), (int) batch.size(), results.data());
+        total += nanoseconds(before, Clock::now());
+    }
+    return total;
+}
+
+static int runHost(WorkloadGenerator* generator, int stores, int workers)
+{
+    vector<Command> setup, workload;
+    generator->setup(&setup);
+    generator->generate(&workload);
+    StoreHost host(workers);
+    for (int store = 0; store < stores; ++store) {
+        host.addStore(store);
+    }
+    runOnStores(&host, stores, setup);
+    long long total = runOnStores(&host, stores, workload);
+    size_t commands = workload.size() * stores;
+    printf("host: %d stores, %d workers, %zu commands in %.3f s, %.0f ops/s, %zu bytes\n", stores, workers,
+           commands, total / 1e9, commands * 1e9 / (total > 0 ? total : 1), host.memoryUsage());
+    return 0;
+}
+
+static void report(const char* name, vector<long long>& latencies)
+{
+    if (latencies.empty())
+        return;
+    sort(latencies.begin(), latencies.end());
+    long long total = 0;
+    for (long long latency : latencies) {
+        total += latency;
+    }
+    printf("%-18s %10zu %12.0f %8lld %8lld %8lld %8lld %8lld\n", name, latencies.size(),
+           latencies.size() * 1e9 / (total > 0 ? total : 1), percentile(latencies, 0.5), percentile(latencies, 0.9),
+           percentile(latencies, 0.99), percentile(latencies, 0.999), latencies.back());
+}
+
+static const int EXTRA_DIVISOR = 100;
+static const int TOP_K = 10;
+static const int PUT_ON_TOP_BATCH = 4096;
+
+static void runOtherMethods(RecordsCompany* company, const WorkloadConfig& config, int workers)
+{
+    mt19937 random(config.m_seed + 1);
+    IdGenerator recordIds(config.m_records, config.m_distribution, config.m_zipfExponent);
+    int count = max(1, config.m_operations / EXTRA_DIVISOR);
+    vector<long long> columns, sellers, spenders, checkpoints, rollbacks, releases, batches;
+    vector<int> records;
+    for (int i = 0; i < count; ++i) {
+        Clock::time_point before = Clock::now();
+        company->getColumn(recordIds.next(random), &records);
+        columns.push_back(nanoseconds(before, Clock::now()));
+
+        before = Clock::now();
+        company->topSellers(TOP_K, &records);
+        sellers.push_back(nanoseconds(before, Clock::now()));
+
+        before = Clock::now();
+        company->topSpenders(TOP_K, &records);
+        spenders.push_back(nanoseconds(before, Clock::now()));
+
+        //the putOnTop in between is undone, so the stacks stay as the mix left them
+        before = Clock::now();
+        int checkpoint = company->checkpoint().ans();
+        checkpoints.push_back(nanoseconds(before, Clock::now()));
+        company->putOnTop(recordIds.next(random), recordIds.next(random));
+        before = Clock::now();
+        company->rollbackTo(checkpoint);
+        rollbacks.push_back(nanoseconds(before, Clock::now()));
+        before = Clock::now();
+        company->releaseCheckpoints();
+        releases.push_back(nanoseconds(before, Clock::now()));
+    }
+
+    vector<int> tops(PUT_ON_TOP_BATCH), bottoms(PUT_ON_TOP_BATCH);
+    vector<StatusType> statuses(PUT_ON_TOP_BATCH);
+    for (int done = 0; done < count; done += PUT_ON_TOP_BATCH) {
+        for (int i = 0; i < PUT_ON_TOP_BATCH; ++i) {
+            tops[i] = recordIds.next(random);
+            bottoms[i] = recordIds.next(random);
+        }
+        Clock::time_point before = Clock::now();
+        company->putOnTopBatch(tops.data(), bottoms.data(), PUT_ON_TOP_BATCH, workers, statuses.data());
+        long long perPair = nanoseconds(before, Clock::now()) / PUT_ON_TOP_BATCH;
+        batches.insert(batches.end(), PUT_ON_TOP_BATCH, perPair);
+    }
+
+    report("getColumn", columns);
+    report("topSellers", sellers);
+    report("topSpenders", spenders);
+    report("checkpoint", checkpoints);
+    report("rollbackTo", rollbacks);
+    report("releaseCheckpoints", releases);
+    report("putOnTopBatch", batches);
+}
+
+int main(int argc, char* argv[])
+{
+    WorkloadConfig config;
+    int batch = 0;
+    int cache = 0;
+    int stores = 0;
+    int workers = 1;
+    bool memory = false;
+    bool archive = false;
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument == "memory") {
+            memory = true;
+        } else if (argument == "archive") {
+            archive = true;
+        } else if (argument.compare(0, 6, "batch=") == 0) {
+            batch = atoi(argument.c_str() + 6);
+            if (batch < 1) {
+                fprintf(stderr, "bad argument: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (argument.compare(0, 7, "stores=") == 0 || argument.compare(0, 8, "workers=") == 0) {
+            int value = atoi(argument.c_str() + argument.find('=') + 1);
+            if (value < 1) {
+                fprintf(stderr, "bad argument: %s\n", argv[i]);
+                return -1;
+            }
+            (argument[0] == 's' ? stores : workers) = value;
+        } else if (argument.compare(0, 6, "cache=") == 0) {
+            cache = atoi(argument.c_str() + 6);
+            if (cache < 1) {
+                fprintf(stderr, "bad argument: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!config.parse(argument)) {
+            fprintf(stderr, "bad argument: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    WorkloadGenerator generator(config);
+    if (stores > 0)
+        return runHost(&generator, stores, workers);
+    vector<Command> setup, workload;
+    generator.setup(&setup);
+
+    RecordsCompany* company = new RecordsCompany();
+    company->setCustomerCache(cache);
+    CommandResult result;
+    Clock::time_point start = Clock::now();
+    for (Command& command : setup) {
+        executeCommand(company, command, &result);
+    }
+    printf("setup: %zu commands in %.3f s\n", setup.size(), nanoseconds(start, Clock::now()) / 1e9);
+    if (memory) {
+        runMemory(company);
+        delete company;
+        return 0;
+    }
+    if (batch > 0) {
+        int res = runBatchLookups(company, config, batch);
+        delete company;
+        return res;
+    }
+    generator.generate(&workload);
+
+    vector<vector<long long>> latencies(OP_UNKNOWN);
+    start = Clock::now();
+    for (Command& command : workload) {
+        Clock::time_point before = Clock::now();
+        executeCommand(company, command, &result);
+        latencies[command.m_op].push_back(nanoseconds(before, Clock::now()));
+    }
+    long long total = nanoseconds(start, Clock::now());
+    CacheStats cacheStats = company->stats().m_customerCache;
+
+    printf("run: %zu commands in %.3f s, %.0f ops/s\n", workload.size(), total / 1e9,
+           workload.size() * 1e9 / (total > 0 ? total : 1));
+    if (cacheStats.m_entries > 0) {
+        long long lookups = cacheStats.m_hits + cacheStats.m_misses;
+        printf("customer cache: %d entries, %lld hits, %lld misses, %.1f%% hit rate\n", cacheStats.m_entries,
+               cacheStats.m_hits, cacheStats.m_misses, lookups == 0 ? 0.0 : 100.0 * cacheStats.m_hits / lookups);
+    }
+    printf("%-18s %10s %12s %8s %8s %8s %8s %8s\n", "op", "count", "ops/s", "p50 ns", "p90 ns", "p99 ns",
+           "p99.9 ns", "max ns");
+    for (int op = 0; op < OP_UNKNOWN; ++op) {
+        report(opCodeName((OpCode) op), latencies[op]);
+    }
+    runOtherMethods(company, config, workers);
+    int res = archive ? runArchive(company, config.m_records) : 0;
+    delete company;
+    return res;
+}
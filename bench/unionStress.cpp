@@ -0,0 +1,245 @@
+#include "../ConcurrentUnionFind.h"
+#include "../UnionFind.h"
+#include "../recordsCompany.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Multi-threaded putOnTop / getPlace stress test of ConcurrentUnionFind, checked against UnionFind.
+ * Usage: unionStress [records=N] [pairs=N] [threads=N] [rounds=N] [seed=N]
+ * Each round runs pairs random unions on threads threads while as many readers call getPlace, then replays
+ * the successful unions in ticket order on a UnionFind and compares every place and column. It also checks
+ * RecordsCompany::putOnTopBatch: against putOnTop in order for unions on disjoint stacks, and against
+ * replaying its write-ahead log for overlapping ones. Prints the parallel and sequential times and exits
+ * with 1 on the first mismatch.
+ * Build (from the repository root):
+ *   g++ -std=c++11 -O2 -pthread bench/unionStress.cpp $(ls *.cpp | grep -v mainWet2) -o unionStress
+ */
+
+typedef chrono::steady_clock Clock;
+
+static long long milliseconds(Clock::time_point from, Clock::time_point to)
+{
+    return chrono::duration_cast<chrono::milliseconds>(to - from).count();
+}
+
+static bool fail(const char* what, int round, int id)
+{
+    fprintf(stderr, "round %d: %s differs at %d\n", round, what, id);
+    return false;
+}
+
+static pair<int, int> placeOf(RecordsCompany& company, int id)
+{
+    pair<int, int> place;
+    company.getPlace(id, &place.first, &place.second);
+    return place;
+}
+
+static bool samePlaces(RecordsCompany& expected, RecordsCompany& actual, int round, int records, const char* what)
+{
+    for (int i = 0; i < records; ++i) {
+        if (placeOf(expected, i) != placeOf(actual, i))
+            return fail(what, round, i);
+    }
+    return true;
+}
+
+static bool concurrentRound(int round, const vector<int>& stocks, const vector<int>& tops, const vector<int>& bottoms,
+                            int threads)
+{
+    int records = stocks.size();
+    int pairs = tops.size();
+    int totalHeight = 0;
+    for (int stock : stocks) {
+        totalHeight += stock;
+    }
+    ConcurrentUnionFind concurrent;
+    concurrent.init(stocks.data(), records);
+    vector<int> tickets(pairs, -1);
+    atomic<bool> done(false);
+    atomic<int> badReads(0);
+
+    Clock::time_point start = Clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = t; i < pairs; i += threads) {
+                if (!concurrent.unionSets(tops[i], bottoms[i], &tickets[i]))
+                    tickets[i] = -1;
+            }
+        });
+        workers.emplace_back([&, t] {
+            mt19937 random(round * 1000 + t);
+            while (!done.load(memory_order_relaxed)) {
+                int id = random() % records;
+                pair<int, int> place = concurrent.getPlace(id);
+                if (place.first < 0 || place.first >= records || place.second < 0 || place.second > totalHeight)
+                    badReads++;
+            }
+        });
+    }
+    for (size_t i = 0; i < workers.size(); i += 2) {
+        workers[i].join();
+    }
+    long long parallel = milliseconds(start, Clock::now());
+    done = true;
+    for (size_t i = 1; i < workers.size(); i += 2) {
+        workers[i].join();
+    }
+    if (badReads != 0)
+        return fail("a concurrent getPlace", round, -1);
+
+    vector<int> byTicket(pairs, -1);
+    for (int i = 0; i < pairs; ++i) {
+        if (tickets[i] != -1) {
+            if (tickets[i] < 0 || tickets[i] >= pairs || byTicket[tickets[i]] != -1)
+                return fail("ticket", round, i);
+            byTicket[tickets[i]] = i;
+        }
+    }
+    UnionFind expected;
+    expected.init(stocks.data(), records);
+    start = Clock::now();
+    for (int i : byTicket) {
+        if (i == -1)
+            break;
+        if (!expected.unionSets(tops[i], bottoms[i]))
+            return fail("union", round, i);
+    }
+    long long sequential = milliseconds(start, Clock::now());
+    for (int i = 0; i < pairs; ++i) {
+        if (tickets[i] == -1 && expected.find(tops[i], nullptr) != expected.find(bottoms[i], nullptr))
+            return fail("failed union", round, i);
+    }
+    for (int i = 0; i < records; ++i) {
+        if (expected.getPlace(i) != concurrent.getPlace(i))
+            return fail("place", round, i);
+    }
+    vector<int> column;
+    for (int i = 0; i < records; ++i) {
+        if (expected.getPlace(i).first != i)
+            continue;
+        expected.getColumn(i, &column);
+        int cur = i;
+        for (int id : column) {
+            if (cur != id)
+                return fail("column", round, i);
+            cur = concurrent.getNext(cur);
+        }
+        if (cur != -1 || concurrent.getLast(i) != column.back())
+            return fail("column", round, i);
+    }
+    printf("round %d: %d unions on %d threads %lld ms, sequential replay %lld ms\n", round, pairs, threads, parallel,
+           sequential);
+    return true;
+}
+
+static bool batchRound(int round, vector<int>& stocks, const vector<int>& tops, const vector<int>& bottoms,
+                       int threads, mt19937& random)
+{
+    int records = stocks.size();
+    string logPath = "unionStress-" + to_string(round) + ".wal";
+    remove(logPath.c_str());
+
+    //overlapping unions, checked by replaying the log putOnTopBatch wrote
+    RecordsCompany company;
+    company.enableLog(logPath, DURABILITY_NONE, 1);
+    company.newMonth(stocks.data(), records);
+    vector<StatusType> statuses(tops.size());
+    if (company.putOnTopBatch(tops.data(), bottoms.data(), tops.size(), threads, statuses.data()) != SUCCESS)
+        return fail("putOnTopBatch", round, -1);
+    company.disableLog();
+    RecordsCompany recovered;
+    if (recovered.recover("", logPath) != SUCCESS)
+        return fail("recover", round, -1);
+    remove(logPath.c_str());
+    if (!samePlaces(company, recovered, round, records, "replayed place"))
+        return false;
+
+    //unions on disjoint stacks: pairs of records, so the batch must match putOnTop in order
+    vector<int> order(records);
+    for (int i = 0; i < records; ++i) {
+        order[i] = i;
+    }
+    shuffle(order.begin(), order.end(), random);
+    vector<int> disjointTops, disjointBottoms;
+    for (int i = 0; i + 1 < records; i += 2) {
+        disjointTops.push_back(order[i]);
+        disjointBottoms.push_back(order[i + 1]);
+    }
+    //a few invalid and repeated ones for the statuses
+    disjointTops.push_back(-1);
+    disjointBottoms.push_back(0);
+    disjointTops.push_back(records);
+    disjointBottoms.push_back(0);
+    RecordsCompany single, batched;
+    single.newMonth(stocks.data(), records);
+    batched.newMonth(stocks.data(), records);
+    statuses.resize(disjointTops.size());
+    batched.putOnTopBatch(disjointTops.data(), disjointBottoms.data(), disjointTops.size(), threads,
+                          statuses.data());
+    for (size_t i = 0; i < disjointTops.size(); ++i) {
+        if (single.putOnTop(disjointTops[i], disjointBottoms[i]) != statuses[i])
+            return fail("batch status", round, i);
+    }
+    return samePlaces(single, batched, round, records, "batch place");
+}
+
+int main(int argc, char* argv[])
+{
+    int records = 100000;
+    int pairs = 100000;
+    int threads = 4;
+    int rounds = 10;
+    int seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        int value = equals == string::npos ? 0 : atoi(argument.c_str() + equals + 1);
+        string name = argument.substr(0, equals);
+        if (name == "records" && value > 1) {
+            records = value;
+        } else if (name == "pairs" && value > 0) {
+            pairs = value;
+        } else if (name == "threads" && value > 0) {
+            threads = value;
+        } else if (name == "rounds" && value > 0) {
+            rounds = value;
+        } else if (name == "seed") {
+            seed = value;
+        } else {
+            fprintf(stderr, "bad argument: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    mt19937 random(seed);
+    for (int round = 0; round < rounds; ++round) {
+        vector<int> stocks(records);
+        for (int& stock : stocks) {
+            stock = random() % 4;
+        }
+        //a few hot stacks so unions keep running into each other
+        int hot = round % 2 == 0 ? records : 1 + records / 1000;
+        vector<int> tops(pairs), bottoms(pairs);
+        for (int i = 0; i < pairs; ++i) {
+            tops[i] = random() % records;
+            bottoms[i] = random() % 2 == 0 ? random() % hot : random() % records;
+        }
+        if (!concurrentRound(round, stocks, tops, bottoms, threads) ||
+            !batchRound(round, stocks, tops, bottoms, threads, random))
+            return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -1,123 +1,88 @@
 #include "recordsCompany.h"
 #include "utilesWet2.h"
+#include "CommandParser.h"
+#include "CommandExecutor.h"
+#include "OutputWriter.h"
+#include "CommandLog.h"
+#include "Pipeline.h"
 #include <string>
-#include <iostream>
-#include <vector>
 
 //#define DEBUG
 
 using namespace std;
 
-void print(string cmd, StatusType res);
+int runText(FILE* input, FILE* output);
 
-void print(string cmd, Output_t<bool> res);
+int runReplay(FILE* input, FILE* output);
 
-template<typename T>
-void print(string cmd, Output_t<T> res);
-
-vector<int> getRecordsStocks();
-
-int main()
+/*
+ * mainWet2                              runs test0.in into test0.out
+ * mainWet2 --convert <text> <binary>    encodes a text command file as a binary log
+ * mainWet2 --replay <binary>            runs a binary log, printing to stdout
+ * mainWet2 --pipeline <text>            runs a text command file on parse/execute/format threads
+ */
+int main(int argc, char* argv[])
 {
+    if (argc == 4 && !string(argv[1]).compare("--convert"))
+    {
+        FILE* text = fopen(argv[2], "r");
+        FILE* binary = fopen(argv[3], "wb");
+        if (text == nullptr || binary == nullptr)
+            return -1;
+        bool converted = convertTextLog(text, binary);
+        fclose(text);
+        fclose(binary);
+        return converted ? 0 : -1;
+    }
+    if (argc == 3 && !string(argv[1]).compare("--replay"))
+    {
+        FILE* binary = fopen(argv[2], "rb");
+        if (binary == nullptr)
+            return -1;
+        int res = runReplay(binary, stdout);
+        fclose(binary);
+        return res;
+    }
+    if (argc == 3 && !string(argv[1]).compare("--pipeline"))
+    {
+        FILE* text = fopen(argv[2], "r");
+        if (text == nullptr)
+            return -1;
+        int res = runPipeline(text, stdout);
+        fclose(text);
+        return res;
+    }
+
     freopen("test0.in", "r", stdin);
 #ifndef DEBUG
     freopen("test0.out", "w", stdout);
 #endif
 
+    return runText(stdin, stdout);
+}
 
-    string op;
+int runText(FILE* input, FILE* output)
+{
+    CommandScanner scanner(input);
+    OutputWriter out(output);
+    Command command;
+    CommandResult result;
     RecordsCompany *test_obj = new RecordsCompany();
-    while (cin >> op)
+    while (scanner.next(&command))
     {
-
-        // check operation
-        if (!op.compare("newMonth"))
-        {
-            // get params
-            vector<int> stocks_vec = getRecordsStocks();
-
-            // call function
-            print(op, test_obj->newMonth(&stocks_vec[0], stocks_vec.size()));
-        }
-        else if (!op.compare("addCostumer"))
-        {
-            int c_id, phone;
-            cin >> c_id; cin >> phone;
-
-            print(op, test_obj->addCostumer(c_id, phone));
-        }
-        else if(!op.compare("getPhone"))
-        {
-            int c_id;
-            cin >> c_id;
-
-            print(op, test_obj->getPhone(c_id));
-        }
-        else if(!op.compare("makeMember"))
-        {
-            int c_id;
-            cin >> c_id;
-
-            print(op, test_obj->makeMember(c_id));
-        }
-        else if(!op.compare("isMember"))
-        {
-            int c_id;
-            cin >> c_id;
-
-            print(op, test_obj->isMember(c_id));
-        }
-        else if(!op.compare("buyRecord"))
-        {
-            int c_id, r_id;
-            cin >> c_id; cin >> r_id;
-
-            print(op, test_obj->buyRecord(c_id, r_id));
-        }
-        else if(!op.compare("addPrize"))
-        {
-            int c_id1, c_id2, amount;
-            cin >> c_id1; cin >> c_id2; cin >> amount;
-
-            print(op, test_obj->addPrize(c_id1, c_id2, amount));
-        }
-        else if(!op.compare("getExpenses"))
-        {
-            int c_id;
-            cin >> c_id;
-
-            print(op, test_obj->getExpenses(c_id));
-        }
-        else if(!op.compare("putOnTop"))
+        executeCommand(test_obj, command, &result);
+        printResult(out, result);
+        if (result.m_kind == RESULT_UNKNOWN)
         {
-            int r_id1, r_id2;
-            cin >> r_id1; cin >> r_id2;
-
-            print(op, test_obj->putOnTop(r_id1, r_id2));
-        }
-        else if(!op.compare("getPlace"))
-        {
-            int r_id, column, hight;
-            cin >> r_id;
-            StatusType res = test_obj->getPlace(r_id, &column, &hight);
-            if (res != StatusType::SUCCESS)
-            {
-                print(op, res);
-            }
-            else
-            {
-                cout << op << ": column=" << column << ", hight=" << hight << endl;
-            }
-        }
-        else
-        {
-            cout << "Unknown command: " << op << endl;
+            delete test_obj;
             return -1;
         }
         // Verify no faults
-        if (cin.fail())
+        if (scanner.failed())
         {
-            cout << "Invalid input format " << endl;
+            out.write("Invalid input format ");
+            out.newLine();
+            delete test_obj;
             return -1;
         }
     }
@@ -125,65 +90,36 @@ int main()
     return 0;
 }
 
-static const char *StatusTypeStr[] =
-        {
-                "SUCCESS",
-                "ALLOCATION_ERROR",
-                "INVALID_INPUT",
-                "FAILURE",
-                "ALREADY_EXISTS",
-                "DOESNT_EXISTS"
-        };
-
-void print(string cmd, StatusType res)
-{
-    cout << cmd << ": " << StatusTypeStr[(int) res] << endl;
-}
-
-
-void print(string cmd, Output_t<bool> res)
+int runReplay(FILE* input, FILE* output)
 {
-    if (res.is_res())
-    {
-        if (res.ans())
-            cout << cmd << ": True" << endl;
-        else
-            cout << cmd << ": False" << endl;
-    }
-    else
+    OutputWriter out(output);
+    if (!readCommandLogHeader(input))
     {
-        cout << cmd << ": " << StatusTypeStr[(int) res.status()] << endl;
+        out.write("Invalid log format ");
+        out.newLine();
+        return -1;
     }
-}
-
-
-template<typename T>
-void print(string cmd, Output_t<T> res)
-{
-    if (res.is_res())
+    CommandLogReader reader(input);
+    Command command;
+    CommandResult result;
+    RecordsCompany *test_obj = new RecordsCompany();
+    while (reader.next(&command))
     {
-        cout << cmd << ": " << res.ans() << endl;
+        executeCommand(test_obj, command, &result);
+        printResult(out, result);
+        // Like the driver, an unknown command ends the run
+        if (result.m_kind == RESULT_UNKNOWN)
+        {
+            delete test_obj;
+            return -1;
+        }
     }
-    else
+    delete test_obj;
+    if (reader.failed())
     {
-        cout << cmd << ": " << StatusTypeStr[(int) res.status()] << endl;
+        out.write("Invalid log format ");
+        out.newLine();
+        return -1;
     }
+    return 0;
 }
-
-vector<int> getRecordsStocks()
-{
-    int num, len;
-    cin >> len;
-    char bracket;
-    cin >> bracket;
-
-    vector<int> stocks_vec = vector<int>();
-    for(int i = 0; i < len; i ++)
-    {
-        cin >> num;
-        stocks_vec.push_back(num);
-    }
-    cin >> bracket;
-
-    return stocks_vec;
-}
\ No newline at end of file
@@ -3,65 +3,152 @@
 //
 
 #include "recordsCompany.h"
+#include <climits>
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
 
-using std::shared_ptr;
-
-RecordsCompany::RecordsCompany() : m_records(nullptr), m_numberOfRecords(0)
+RecordsCompany::RecordsCompany() : m_numberOfRecords(0), m_logGeneration(0), m_logOffset(0),
+                                   m_archiveMode(ARCHIVE_OFF), m_diskMonths(0), m_monthOpen(false),
+                                   m_replaying(false), m_archiveStatus(SUCCESS)
 {}
 
 RecordsCompany::~RecordsCompany()
 {
-    delete[] m_records;
+    waitForSnapshot();
+    m_log.close();
+}
+
+static Customer* rawCustomer(const CustomerRef& customer)
+{
+#ifdef RC_COMPACT
+    return customer;
+#else
+    return customer.get();
+#endif
+}
+
+CustomerRef RecordsCompany::newCustomer(int phone)
+{
+#ifdef RC_COMPACT
+    return m_customerPool.create(phone);
+#else
+    return std::make_shared<Customer>(phone);
+#endif
+}
+
+void RecordsCompany::releaseCustomer(const CustomerRef& customer)
+{
+#ifdef RC_COMPACT
+    m_customerPool.release(customer);
+#else
+    //the last shared_ptr frees it
+    (void) customer;
+#endif
+}
+
+Customer* RecordsCompany::findCustomer(int c_id)
+{
+    if (!m_customerCache.enabled()) {
+        CustomerRef* customer = m_customers.find(c_id);
+        return customer == nullptr ? nullptr : rawCustomer(*customer);
+    }
+
+    Customer* cached = m_customerCache.find(c_id);
+    if (cached != nullptr)
+        return cached;
+    CustomerRef* customer = m_customers.find(c_id);
+    if (customer == nullptr)
+        return nullptr;
+    m_customerCache.insert(c_id, rawCustomer(*customer));
+    return rawCustomer(*customer);
 }
 
 StatusType RecordsCompany::newMonth(int* records_stocks, int number_of_records)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_NEW_MONTH]);)
     if (number_of_records < 0)
         return INVALID_INPUT;
 
+    m_archiveStatus = SUCCESS;
+    if (m_archiveMode != ARCHIVE_OFF && m_monthOpen && !(m_replaying && m_archiveMode == ARCHIVE_DISK))
+        m_archiveStatus = sealMonth();
     m_numberOfRecords = number_of_records;
-    delete[] m_records;
 
     try {
-        m_records = new int[number_of_records];
-        for (int i = 0; i < number_of_records; ++i) {
-            m_records[i] = 0;
-        }
+        m_records.init(number_of_records);
         m_recordsUF.init(records_stocks, number_of_records);
     } catch (std::bad_alloc& e) {
         return ALLOCATION_ERROR;
     }
-    m_clubMembers.resetExpenses(m_clubMembers.getRoot());
+    m_clubMembers.forEachInOrder([](const int&, const CustomerRef& customer) { customer->resetExpenses(); });
+    m_clubMembers.resetExtras();
+    m_monthOpen = true;
+
+    if (m_log.isOpen())
+        m_log.appendStocks(OP_NEW_MONTH, records_stocks, number_of_records);
+    return SUCCESS;
+}
+
+//adds records with new ids after the existing ones, keeping this month's stacks and sales
+StatusType RecordsCompany::addRecords(int* records_stocks, int number_of_records)
+{
+    if (number_of_records < 0 || (records_stocks == nullptr && number_of_records > 0))
+        return INVALID_INPUT;
+
+    try {
+        m_recordsUF.append(records_stocks, number_of_records);
+        m_records.append(number_of_records);
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
 
+    m_numberOfRecords += number_of_records;
+
+    if (m_log.isOpen())
+        m_log.appendStocks(OP_ADD_RECORDS, records_stocks, number_of_records);
     return SUCCESS;
 }
 
 StatusType RecordsCompany::addCostumer(int c_id, int phone)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_ADD_COSTUMER]);)
     if (c_id < 0 || phone < 0)
         return INVALID_INPUT;
 
-    shared_ptr<Customer> customer = m_customers.find(c_id);
-    if (customer != nullptr)
+    //the customer is only allocated once the id is known to be new
+    if (m_customers.find(c_id) != nullptr)
         return ALREADY_EXISTS;
 
-
-    customer = std::make_shared<Customer>(c_id, phone);
+    CustomerRef customer = CustomerRef();
+    try {
+        customer = newCustomer(phone);
+        m_customers.tryEmplace(c_id, customer);
+    } catch (std::bad_alloc& e) {
+        releaseCustomer(customer);
+        return ALLOCATION_ERROR;
+    }
     try {
-        m_customers.insert(c_id, customer);
+        m_phones.tryEmplace(PhoneKey{phone, c_id});
     } catch (std::bad_alloc& e) {
+        m_customers.remove(c_id);
+        m_customerCache.invalidate(c_id);
+        releaseCustomer(customer);
         return ALLOCATION_ERROR;
     }
 
+    if (m_log.isOpen())
+        m_log.append(OP_ADD_COSTUMER, c_id, phone);
     return SUCCESS;
 }
 
 Output_t<int> RecordsCompany::getPhone(int c_id)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_GET_PHONE]);)
     if (c_id < 0)
         return {INVALID_INPUT};
 
-    shared_ptr<Customer> customer = m_customers.find(c_id);
+    Customer* customer = findCustomer(c_id);
     if (customer == nullptr)
         return {DOESNT_EXISTS};
 
@@ -70,87 +157,262 @@ Output_t<int> RecordsCompany::getPhone(int c_id)
 
 Output_t<bool> RecordsCompany::isMember(int c_id)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_IS_MEMBER]);)
     if (c_id < 0)
         return {INVALID_INPUT};
 
-    shared_ptr<Customer> customer = m_customers.find(c_id);
+    Customer* customer = findCustomer(c_id);
     if (customer == nullptr)
         return {DOESNT_EXISTS};
 
     return {(customer->isClubMember())};
 }
 
+Output_t<int> RecordsCompany::getCustomerByPhone(int phone)
+{
+    if (phone < 0)
+        return {INVALID_INPUT};
+
+    //the first customer with the phone is the lowest key from {phone, 0} on
+    const PhoneKey* first = m_phones.lowerBound(PhoneKey{phone, 0});
+    if (first == nullptr || first->m_phone != phone)
+        return {DOESNT_EXISTS};
+
+    return {first->m_id};
+}
+
+StatusType RecordsCompany::getCustomersByPhone(int phone, std::vector<int> *customers)
+{
+    if (phone < 0 || customers == nullptr)
+        return INVALID_INPUT;
+
+    customers->clear();
+    try {
+        m_phones.forEachInRange(PhoneKey{phone, 0}, PhoneKey{phone, INT_MAX}, [customers](const PhoneKey& key, NoValue) {
+            customers->push_back(key.m_id);
+        });
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+void RecordsCompany::findCustomers(const int* c_ids, int count, Customer** customers)
+{
+    int ids[LOOKUP_CHUNK];
+    int positions[LOOKUP_CHUNK];
+    CustomerRef* found[LOOKUP_CHUNK];
+    int valid = 0;
+    for (int i = 0; i < count; ++i) {
+        customers[i] = nullptr;
+        if (c_ids[i] < 0)
+            continue;
+        ids[valid] = c_ids[i];
+        positions[valid++] = i;
+    }
+
+    if (valid == 0)
+        return;
+    m_customers.findBatch(ids, valid, found);
+    for (int i = 0; i < valid; ++i) {
+        if (found[i] != nullptr)
+            RC_PREFETCH(rawCustomer(*found[i]));
+    }
+    for (int i = 0; i < valid; ++i) {
+        if (found[i] != nullptr)
+            customers[positions[i]] = rawCustomer(*found[i]);
+    }
+}
+
+StatusType RecordsCompany::getPhoneBatch(const int* c_ids, int count, int* phones, StatusType* statuses)
+{
+    if (count < 0 || (count > 0 && (c_ids == nullptr || phones == nullptr || statuses == nullptr)))
+        return INVALID_INPUT;
+
+    Customer* customers[LOOKUP_CHUNK];
+    for (int start = 0; start < count; start += LOOKUP_CHUNK) {
+        int size = count - start < LOOKUP_CHUNK ? count - start : LOOKUP_CHUNK;
+        findCustomers(c_ids + start, size, customers);
+        for (int i = 0; i < size; ++i) {
+            Customer* customer = customers[i];
+            phones[start + i] = customer == nullptr ? 0 : customer->getPhoneNumber();
+            if (c_ids[start + i] < 0)
+                statuses[start + i] = INVALID_INPUT;
+            else
+                statuses[start + i] = customer == nullptr ? DOESNT_EXISTS : SUCCESS;
+        }
+    }
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::isMemberBatch(const int* c_ids, int count, bool* members, StatusType* statuses)
+{
+    if (count < 0 || (count > 0 && (c_ids == nullptr || members == nullptr || statuses == nullptr)))
+        return INVALID_INPUT;
+
+    Customer* customers[LOOKUP_CHUNK];
+    for (int start = 0; start < count; start += LOOKUP_CHUNK) {
+        int size = count - start < LOOKUP_CHUNK ? count - start : LOOKUP_CHUNK;
+        findCustomers(c_ids + start, size, customers);
+        for (int i = 0; i < size; ++i) {
+            Customer* customer = customers[i];
+            members[start + i] = customer != nullptr && customer->isClubMember();
+            if (c_ids[start + i] < 0)
+                statuses[start + i] = INVALID_INPUT;
+            else
+                statuses[start + i] = customer == nullptr ? DOESNT_EXISTS : SUCCESS;
+        }
+    }
+    return SUCCESS;
+}
+
 //-------------------------------------------------------------
 
 StatusType RecordsCompany::makeMember(int c_id)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_MAKE_MEMBER]);)
     if (c_id < 0)
         return INVALID_INPUT;
 
-    shared_ptr<Customer> customer = m_customers.find(c_id);
+    CustomerRef* customer = m_customers.find(c_id);
     if (customer == nullptr)
         return DOESNT_EXISTS;
 
-    if (customer->isClubMember())
+    if ((*customer)->isClubMember())
         return ALREADY_EXISTS;
 
-    customer->makeMember();
+    (*customer)->makeMember();
     try {
-        m_clubMembers.insert(customer->getID(), customer);
+        //the member tree shares the customer
+        m_clubMembers.insert(c_id, *customer);
     } catch (std::bad_alloc& e) {
         return ALLOCATION_ERROR;
     }
 
+    if (m_log.isOpen())
+        m_log.append(OP_MAKE_MEMBER, c_id);
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::revokeMembership(int c_id)
+{
+    if (c_id < 0)
+        return INVALID_INPUT;
+
+    Customer* customer = findCustomer(c_id);
+    if (customer == nullptr || !customer->isClubMember())
+        return DOESNT_EXISTS;
+
+    m_clubMembers.remove(c_id);
+    customer->revokeMembership();
+
+    if (m_log.isOpen())
+        m_log.append(OP_REVOKE_MEMBERSHIP, c_id);
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::removeCustomer(int c_id)
+{
+    if (c_id < 0)
+        return INVALID_INPUT;
+
+    CustomerRef* found = m_customers.find(c_id);
+    if (found == nullptr)
+        return DOESNT_EXISTS;
+
+    //the table's reference goes away with its node
+    CustomerRef customer = *found;
+    if (customer->isClubMember())
+        m_clubMembers.remove(c_id);
+    m_phones.remove(PhoneKey{customer->getPhoneNumber(), c_id});
+    m_customers.remove(c_id);
+    m_customerCache.invalidate(c_id);
+    releaseCustomer(customer);
+
+    if (m_log.isOpen())
+        m_log.append(OP_REMOVE_CUSTOMER, c_id);
     return SUCCESS;
 }
 
 StatusType RecordsCompany::buyRecord(int c_id, int r_id)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_BUY_RECORD]);)
     if (c_id < 0 || r_id < 0)
         return INVALID_INPUT;
 
     if (r_id >= m_numberOfRecords)
         return DOESNT_EXISTS;
 
-    shared_ptr<Customer> customer = m_customers.find(c_id);
+    Customer* customer = findCustomer(c_id);
     if (customer == nullptr)
         return DOESNT_EXISTS;
 
-    customer->buyRecord(m_records[r_id]);
-    m_records[r_id]++;
+    int sales = m_records.getSales(r_id);
+    try {
+        m_records.addSale(r_id);
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+    customer->buyRecord(sales);
+    if (customer->isClubMember())
+        m_clubMembers.updatePath(c_id);
 
+    if (m_log.isOpen())
+        m_log.append(OP_BUY_RECORD, c_id, r_id);
     return SUCCESS;
 
 }
 
+//a non-positive or NaN amount becomes 0 cents, which addPrizeCents rejects like one that rounds to 0
 StatusType RecordsCompany::addPrize(int c_id1, int c_id2, double amount)
 {
+    Money cents = amount > 0 ? moneyFromDouble(amount < MAX_MONEY_AMOUNT ? amount : MAX_MONEY_AMOUNT) : 0;
+    return addPrizeCents(c_id1, c_id2, cents);
+}
+
+StatusType RecordsCompany::addPrizeCents(int c_id1, int c_id2, Money amount)
+{
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_ADD_PRIZE]);)
     if (c_id1 < 0 || c_id2 < c_id1 || amount <= 0)
         return INVALID_INPUT;
 
     if (c_id1 == c_id2)
         return SUCCESS;
     m_clubMembers.addPrize(c_id1, c_id2, amount);
+    if (m_log.isOpen())
+        m_log.append(OP_ADD_PRIZE, c_id1, c_id2, amount);
 
     return SUCCESS;
 }
 
 Output_t<double> RecordsCompany::getExpenses(int c_id)
 {
+    Output_t<Money> expenses = getExpensesCents(c_id);
+    if (!expenses.is_res())
+        return {expenses.status()};
+    return {moneyToDouble(expenses.ans())};
+}
+
+Output_t<Money> RecordsCompany::getExpensesCents(int c_id)
+{
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_GET_EXPENSES]);)
     if (c_id < 0)
         return {INVALID_INPUT};
 
-    double expenses = 0;
-    if (!m_clubMembers.sumUpExtra(c_id, &expenses))
+    Money prizes = 0;
+    Node<int, CustomerRef, PrizeAugment>* member = m_clubMembers.sumUpExtra(c_id, &prizes);
+    if (member == nullptr)
         return {DOESNT_EXISTS};
     else
-        return {expenses};
+        return {member->getValue()->getExpenses() - prizes};
 }
 
 //-------------------------------------------------------------
 
 StatusType RecordsCompany::putOnTop(int r_id1, int r_id2)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_PUT_ON_TOP]);)
     if (r_id1 < 0 || r_id2 < 0)
         return INVALID_INPUT;
 
@@ -160,11 +422,64 @@ StatusType RecordsCompany::putOnTop(int r_id1, int r_id2)
     if (!m_recordsUF.unionSets(r_id1, r_id2))
         return FAILURE;
 
+    if (m_log.isOpen())
+        m_log.append(OP_PUT_ON_TOP, r_id1, r_id2);
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::putOnTopBatch(const int* r_id1s, const int* r_id2s, int count, int threads,
+                                         StatusType* statuses)
+{
+    if (count < 0 || (count > 0 && (r_id1s == nullptr || r_id2s == nullptr || statuses == nullptr)))
+        return INVALID_INPUT;
+
+    //undoing a union needs the order they were made in
+    if (threads <= 1 || m_recordsUF.hasCheckpoints()) {
+        for (int i = 0; i < count; ++i) {
+            statuses[i] = putOnTop(r_id1s[i], r_id2s[i]);
+        }
+        return SUCCESS;
+    }
+
+    try {
+        std::vector<int> tops, bottoms, indices;
+        for (int i = 0; i < count; ++i) {
+            if (r_id1s[i] < 0 || r_id2s[i] < 0) {
+                statuses[i] = INVALID_INPUT;
+            } else if (r_id1s[i] >= m_numberOfRecords || r_id2s[i] >= m_numberOfRecords) {
+                statuses[i] = DOESNT_EXISTS;
+            } else {
+                tops.push_back(r_id1s[i]);
+                bottoms.push_back(r_id2s[i]);
+                indices.push_back(i);
+            }
+        }
+        std::vector<int> tickets(tops.size());
+        m_recordsUF.unionSetsParallel(tops.data(), bottoms.data(), tops.size(), threads, tickets.data());
+
+        //the log gets the successful unions in an order that replays to the same stacks
+        std::vector<int> byTicket(tops.size(), -1);
+        for (size_t i = 0; i < tops.size(); ++i) {
+            statuses[indices[i]] = tickets[i] == -1 ? FAILURE : SUCCESS;
+            if (tickets[i] != -1)
+                byTicket[tickets[i]] = i;
+        }
+        if (m_log.isOpen()) {
+            for (int i : byTicket) {
+                if (i == -1)
+                    break;
+                m_log.append(OP_PUT_ON_TOP, tops[i], bottoms[i]);
+            }
+        }
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
     return SUCCESS;
 }
 
 StatusType RecordsCompany::getPlace(int r_id, int *column, int *hight)
 {
+    RC_STATS_ONLY(ScopedLatency timer(&m_latency[STAT_GET_PLACE]);)
     if (r_id < 0 || column == nullptr || hight == nullptr)
         return INVALID_INPUT;
 
@@ -179,3 +494,579 @@ StatusType RecordsCompany::getPlace(int r_id, int *column, int *hight)
     return SUCCESS;
 }
 
+StatusType RecordsCompany::getColumn(int r_id, std::vector<int> *records)
+{
+    if (r_id < 0 || records == nullptr)
+        return INVALID_INPUT;
+
+    if (r_id >= m_numberOfRecords)
+        return DOESNT_EXISTS;
+
+    try {
+        m_recordsUF.getColumn(r_id, records);
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+//-------------------------------------------------------------
+
+Output_t<int> RecordsCompany::checkpoint()
+{
+    int checkpoint;
+    try {
+        checkpoint = m_recordsUF.checkpoint();
+    } catch (std::bad_alloc& e) {
+        return {ALLOCATION_ERROR};
+    }
+    if (m_log.isOpen())
+        m_log.append(OP_CHECKPOINT);
+    return {checkpoint};
+}
+
+//undoes every putOnTop made after the checkpoint
+StatusType RecordsCompany::rollbackTo(int checkpoint)
+{
+    if (checkpoint < 0)
+        return INVALID_INPUT;
+
+    if (!m_recordsUF.rollbackTo(checkpoint))
+        return FAILURE;
+
+    if (m_log.isOpen())
+        m_log.append(OP_ROLLBACK_TO, checkpoint);
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::releaseCheckpoints()
+{
+    m_recordsUF.releaseCheckpoints();
+    if (m_log.isOpen())
+        m_log.append(OP_RELEASE_CHECKPOINTS);
+    return SUCCESS;
+}
+
+//-------------------------------------------------------------
+
+StatusType RecordsCompany::topSellers(int k, std::vector<int> *records)
+{
+    if (k < 0 || records == nullptr)
+        return INVALID_INPUT;
+
+    try {
+        m_records.top(k, records);
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::topSpenders(int k, std::vector<int> *members)
+{
+    if (k < 0 || members == nullptr)
+        return INVALID_INPUT;
+
+    try {
+        m_clubMembers.topByExpenses(k, members);
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+CompanyStats RecordsCompany::stats()
+{
+    CompanyStats stats;
+    RC_STATS_ONLY(stats.m_enabled = true;)
+    stats.m_customers = m_customers.getStats();
+    stats.m_customerCache = m_customerCache.getStats();
+    stats.m_members = m_clubMembers.getSize();
+    stats.m_memberTreeHeight = m_clubMembers.getHeight();
+    stats.m_memberRotations = m_clubMembers.getRotations();
+    stats.m_records = m_numberOfRecords;
+    stats.m_finds = m_recordsUF.getFindStats();
+    stats.m_memory = memoryUsage();
+#ifdef RC_STATS
+    for (int i = 0; i < STAT_OP_COUNT; ++i) {
+        stats.m_latency[i] = m_latency[i];
+    }
+#endif
+    return stats;
+}
+
+MemoryUsage RecordsCompany::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.m_customerBuckets = m_customers.bucketBytes();
+    usage.m_customerNodes = m_customers.nodeBytes();
+#ifdef RC_COMPACT
+    usage.m_customers = m_customerPool.memoryUsage();
+#else
+    //make_shared puts each customer after a control block of a vtable pointer and two counters
+    usage.m_customers = m_customers.getSize() * (sizeof(Customer) + sizeof(void*) + 2 * sizeof(int));
+#endif
+    usage.m_memberNodes = m_clubMembers.nodeBytes();
+    usage.m_phoneIndex = m_phones.bucketBytes() + m_phones.nodeBytes();
+    usage.m_sales = m_records.memoryUsage();
+    usage.m_stacks = m_recordsUF.stackBytes();
+    usage.m_undoLog = m_recordsUF.undoLogBytes();
+    usage.m_customerCache = m_customerCache.memoryUsage();
+    for (const std::shared_ptr<const MonthArchive>& archive : m_archives) {
+        usage.m_archives += archive->byteSize();
+    }
+    return usage;
+}
+
+StatusType RecordsCompany::setCustomerCache(int entries)
+{
+    if (entries < 0)
+        return INVALID_INPUT;
+
+    try {
+        m_customerCache.resize(entries);
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+    return SUCCESS;
+}
+
+//-------------------------------------------------------------
+
+std::string RecordsCompany::archivePath(int month) const
+{
+    return m_archiveDirectory + "/month-" + std::to_string(month) + ".rca";
+}
+
+StatusType RecordsCompany::setArchiving(ArchiveMode mode, const std::string& directory)
+{
+    if (mode == ARCHIVE_DISK && directory.empty())
+        return INVALID_INPUT;
+
+    try {
+        m_archiveMode = mode;
+        m_archiveDirectory = directory;
+        m_diskMonths = 0;
+        if (mode == ARCHIVE_DISK) {
+            while (access(archivePath(m_diskMonths).c_str(), F_OK) == 0) {
+                m_diskMonths++;
+            }
+        }
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+    return SUCCESS;
+}
+
+int RecordsCompany::archivedMonths() const
+{
+    return m_archiveMode == ARCHIVE_DISK ? m_diskMonths : (int) m_archives.size();
+}
+
+StatusType RecordsCompany::lastArchiveStatus() const
+{
+    return m_archiveStatus;
+}
+
+StatusType RecordsCompany::getArchive(int month, std::shared_ptr<const MonthArchive>* archive)
+{
+    if (archive == nullptr || month < 0)
+        return INVALID_INPUT;
+    if (month >= archivedMonths())
+        return FAILURE;
+
+    if (m_archiveMode != ARCHIVE_DISK) {
+        *archive = m_archives[month];
+        return SUCCESS;
+    }
+    try {
+        std::shared_ptr<MonthArchive> loaded = std::make_shared<MonthArchive>();
+        if (!loaded->load(archivePath(month)))
+            return FAILURE;
+        *archive = loaded;
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::sealMonth()
+{
+    try {
+        std::shared_ptr<MonthArchive> archive = std::make_shared<MonthArchive>();
+        m_clubMembers.forEachWithPrize([&archive](const int& c_id, const CustomerRef& customer, Money prize) {
+            archive->appendMember(c_id, customer->getExpenses() - prize);
+        });
+        for (int r_id = 0; r_id < m_numberOfRecords; ++r_id) {
+            archive->appendSales(m_records.getSales(r_id));
+        }
+        if (m_archiveMode == ARCHIVE_DISK) {
+            if (!archive->save(archivePath(m_diskMonths)))
+                return FAILURE;
+            m_diskMonths++;
+        } else {
+            m_archives.push_back(archive);
+        }
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+    return SUCCESS;
+}
+
+//-------------------------------------------------------------
+
+static const char SNAPSHOT_MAGIC[8] = {'R', 'C', 'S', 'N', 'A', 'P', '0', '5'};
+
+class SnapshotCustomer {
+public:
+    int m_id;
+    int m_phone;
+    int m_isMember;
+    Money m_expenses;
+};
+
+class SnapshotMember {
+public:
+    int m_id;
+    //the member's own prize offset in the member tree
+    Money m_prize;
+};
+
+void RecordsCompany::serialize(SnapshotWriter& writer)
+{
+    //entries are written as raw bytes, so their padding is zeroed before the fields are set
+    std::vector<SnapshotCustomer> customers;
+    m_customers.forEach([&customers](const int& c_id, const CustomerRef& customer) {
+        customers.emplace_back();
+        SnapshotCustomer& entry = customers.back();
+        memset(&entry, 0, sizeof(entry));
+        entry.m_id = c_id;
+        entry.m_phone = customer->getPhoneNumber();
+        entry.m_isMember = customer->isClubMember();
+        entry.m_expenses = customer->getExpenses();
+    });
+    std::vector<SnapshotMember> members;
+    m_clubMembers.forEachPreOrder([&members](const int& c_id, const CustomerRef&, Money prize) {
+        members.emplace_back();
+        SnapshotMember& entry = members.back();
+        memset(&entry, 0, sizeof(entry));
+        entry.m_id = c_id;
+        entry.m_prize = prize;
+    });
+
+    writer.writeArray(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    //the log records this snapshot already includes
+    uint32_t logGeneration = m_log.isOpen() ? m_log.getGeneration() : m_logGeneration;
+    long long logOffset = m_log.isOpen() ? m_log.size() : m_logOffset;
+    writer.write(logGeneration);
+    writer.write(logOffset);
+    writer.write(m_numberOfRecords);
+    writer.write((int) m_monthOpen);
+    writer.write((int) customers.size());
+    writer.write((int) members.size());
+    writer.writeArray(customers.data(), customers.size());
+    writer.writeArray(members.data(), members.size());
+    m_records.save(writer);
+    m_recordsUF.save(writer);
+}
+
+StatusType RecordsCompany::saveSnapshot(const std::string& path)
+{
+    StatusType res = saveSnapshotAsync(path);
+    if (res != SUCCESS)
+        return res;
+    return waitForSnapshot();
+}
+
+StatusType RecordsCompany::saveSnapshotAsync(const std::string& path)
+{
+    StatusType previous = waitForSnapshot();
+    if (previous != SUCCESS)
+        return previous;
+
+    try {
+        SnapshotWriter writer;
+        serialize(writer);
+        auto data = std::make_shared<std::vector<char>>();
+        data->swap(writer.data());
+        m_pendingSnapshot = std::async(std::launch::async, [path, data]() {
+            return writeFileAtomically(path, *data);
+        });
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    } catch (std::system_error& e) {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+//waits for the running background save, FAILURE if it couldn't write the file
+StatusType RecordsCompany::waitForSnapshot()
+{
+    if (!m_pendingSnapshot.valid())
+        return SUCCESS;
+    return m_pendingSnapshot.get() ? SUCCESS : FAILURE;
+}
+
+void RecordsCompany::clearCustomers()
+{
+    m_customerCache.clear();
+    m_clubMembers.clear();
+    m_phones.clear();
+    m_customers.clear();
+#ifdef RC_COMPACT
+    m_customerPool.clear();
+#endif
+}
+
+//on a malformed snapshot the company is left empty
+StatusType RecordsCompany::loadSnapshot(const std::string& path)
+{
+    MappedFile file(path);
+    if (!file.isOpen())
+        return FAILURE;
+
+    SnapshotReader reader(file.data(), file.size());
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t logGeneration;
+    long long logOffset;
+    int numberOfRecords, monthOpen, customerCount, memberCount;
+    if (!reader.readArray(magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+        !reader.read(&logGeneration) || !reader.read(&logOffset) || !reader.read(&numberOfRecords) ||
+        !reader.read(&monthOpen) || !reader.read(&customerCount) || !reader.read(&memberCount) ||
+        numberOfRecords < 0 || customerCount < 0 || memberCount < 0 || memberCount > customerCount)
+        return FAILURE;
+
+    try {
+        std::vector<SnapshotCustomer> customers(customerCount);
+        std::vector<SnapshotMember> members(memberCount);
+        if (!reader.readArray(customers.data(), customerCount) || !reader.readArray(members.data(), memberCount))
+            return FAILURE;
+
+        clearCustomers();
+        m_numberOfRecords = 0;
+        m_records.init(0);
+        m_recordsUF.init(nullptr, 0);
+
+        m_customers.reserve(customerCount);
+        m_phones.reserve(customerCount);
+        for (const SnapshotCustomer& entry : customers) {
+            CustomerRef customer = newCustomer(entry.m_phone);
+            if (entry.m_isMember)
+                customer->makeMember();
+            customer->setExpenses(entry.m_expenses);
+            if (!m_customers.tryEmplace(entry.m_id, customer).second) {
+                releaseCustomer(customer);
+                clearCustomers();
+                return FAILURE;
+            }
+            m_phones.tryEmplace(PhoneKey{entry.m_phone, entry.m_id});
+        }
+
+        std::vector<int> memberIds(memberCount);
+        std::vector<CustomerRef> memberCustomers(memberCount);
+        std::vector<Money> prizes(memberCount);
+        for (int i = 0; i < memberCount; ++i) {
+            memberIds[i] = members[i].m_id;
+            CustomerRef* customer = m_customers.find(members[i].m_id);
+            if (customer == nullptr) {
+                clearCustomers();
+                return FAILURE;
+            }
+            memberCustomers[i] = *customer;
+            prizes[i] = members[i].m_prize;
+        }
+        if (!m_clubMembers.buildFromPreOrder(memberIds.data(), memberCustomers.data(), prizes.data(), memberCount)) {
+            clearCustomers();
+            return FAILURE;
+        }
+
+        if (!m_records.load(reader) || !m_recordsUF.load(reader) || !reader.atEnd() ||
+            m_records.size() != numberOfRecords || m_recordsUF.getSize() != numberOfRecords) {
+            clearCustomers();
+            m_records.init(0);
+            m_recordsUF.init(nullptr, 0);
+            return FAILURE;
+        }
+        m_numberOfRecords = numberOfRecords;
+        m_monthOpen = monthOpen != 0;
+        m_logGeneration = logGeneration;
+        m_logOffset = logOffset;
+    } catch (std::bad_alloc& e) {
+        clearCustomers();
+        return ALLOCATION_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+//-------------------------------------------------------------
+
+StatusType RecordsCompany::enableLog(const std::string& path, Durability durability, int groupSize)
+{
+    if (groupSize < 1)
+        return INVALID_INPUT;
+
+    try {
+        if (!m_log.open(path, durability, groupSize, m_logGeneration + 1))
+            return FAILURE;
+    } catch (std::bad_alloc& e) {
+        return ALLOCATION_ERROR;
+    }
+    //an existing log must be the one this state continues
+    if (m_log.getGeneration() != m_logGeneration && m_log.getGeneration() != m_logGeneration + 1) {
+        m_log.close();
+        return FAILURE;
+    }
+    m_logGeneration = m_log.getGeneration();
+    return SUCCESS;
+}
+
+StatusType RecordsCompany::disableLog()
+{
+    if (!m_log.isOpen())
+        return FAILURE;
+    bool committed = m_log.commit();
+    m_logOffset = m_log.size();
+    m_log.close();
+    return committed ? SUCCESS : FAILURE;
+}
+
+StatusType RecordsCompany::commitLog()
+{
+    if (!m_log.isOpen())
+        return FAILURE;
+    return m_log.commit() ? SUCCESS : FAILURE;
+}
+
+/*
+ * The snapshot records the log generation and size it covers before the log is truncated,
+ * so a crash between the two still recovers every operation exactly once.
+ */
+StatusType RecordsCompany::compactLog(const std::string& snapshotPath)
+{
+    if (!m_log.isOpen())
+        return FAILURE;
+    if (!m_log.commit())
+        return FAILURE;
+
+    StatusType res = saveSnapshot(snapshotPath);
+    if (res != SUCCESS)
+        return res;
+    if (!m_log.truncate())
+        return FAILURE;
+    m_logGeneration = m_log.getGeneration();
+    return SUCCESS;
+}
+
+//applies a logged mutation, queries never reach the log
+void RecordsCompany::applyLogged(Command& command)
+{
+    const int* args = command.m_args;
+    switch (command.m_op) {
+        case OP_NEW_MONTH:
+            newMonth(command.m_stocks.data(), command.m_stocks.size());
+            break;
+        case OP_ADD_RECORDS:
+            addRecords(command.m_stocks.data(), command.m_stocks.size());
+            break;
+        case OP_ADD_COSTUMER:
+            addCostumer(args[0], args[1]);
+            break;
+        case OP_MAKE_MEMBER:
+            makeMember(args[0]);
+            break;
+        case OP_REVOKE_MEMBERSHIP:
+            revokeMembership(args[0]);
+            break;
+        case OP_REMOVE_CUSTOMER:
+            removeCustomer(args[0]);
+            break;
+        case OP_BUY_RECORD:
+            buyRecord(args[0], args[1]);
+            break;
+        case OP_ADD_PRIZE:
+            addPrizeCents(args[0], args[1], command.m_amount);
+            break;
+        case OP_PUT_ON_TOP:
+            putOnTop(args[0], args[1]);
+            break;
+        case OP_CHECKPOINT:
+            checkpoint();
+            break;
+        case OP_ROLLBACK_TO:
+            rollbackTo(args[0]);
+            break;
+        case OP_RELEASE_CHECKPOINTS:
+            releaseCheckpoints();
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * Loads the snapshot, if there is one, and replays the log records it doesn't cover.
+ * A record cut short by a crash at the end of the log is ignored.
+ */
+StatusType RecordsCompany::recover(const std::string& snapshotPath, const std::string& logPath)
+{
+    if (m_log.isOpen())
+        return FAILURE;
+
+    m_logOffset = 0;
+    FILE* snapshot = fopen(snapshotPath.c_str(), "rb");
+    if (snapshot != nullptr) {
+        fclose(snapshot);
+        StatusType res = loadSnapshot(snapshotPath);
+        if (res != SUCCESS)
+            return res;
+    }
+
+    FILE* log = fopen(logPath.c_str(), "rb");
+    if (log == nullptr)
+        return SUCCESS;
+    uint32_t generation;
+    if (!WriteAheadLog::readHeader(log, &generation)) {
+        fclose(log);
+        return SUCCESS;
+    }
+    //a log one generation ahead was truncated after the snapshot, all of it is new
+    if (generation == m_logGeneration + 1) {
+        m_logOffset = 0;
+    } else if (generation != m_logGeneration) {
+        fclose(log);
+        return FAILURE;
+    }
+    long long start = ftell(log);
+    if (fseek(log, m_logOffset, SEEK_CUR) != 0) {
+        fclose(log);
+        return FAILURE;
+    }
+
+    bool torn;
+    try {
+        CommandLogReader reader(log);
+        Command command;
+        m_replaying = true;
+        while (reader.next(&command)) {
+            applyLogged(command);
+        }
+        m_replaying = false;
+        torn = reader.failed();
+        m_logOffset += reader.consumed();
+    } catch (std::bad_alloc& e) {
+        m_replaying = false;
+        fclose(log);
+        return ALLOCATION_ERROR;
+    }
+    fclose(log);
+    m_logGeneration = generation;
+    //cut the torn record so new records aren't appended after it
+    if (torn && ::truncate(logPath.c_str(), start + m_logOffset) != 0)
+        return FAILURE;
+    return SUCCESS;
+}
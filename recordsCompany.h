@@ -3,32 +3,170 @@
 
 #include "utilesWet2.h"
 #include "Customer.h"
+#include "CustomerCache.h"
+#include "CustomerPool.h"
+#include "PhoneKey.h"
 #include "HashTable.h"
+#include "MonthArchive.h"
 #include "Tree.h"
 #include "UnionFind.h"
+#include "SalesRanking.h"
+#include "Stats.h"
+#include "Snapshot.h"
+#include "WriteAheadLog.h"
+#include <future>
 #include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * The compact configuration keeps the customers in a pool and stores plain pointers to them,
+ * the default one shares each customer between the table and the member tree with a shared_ptr.
+ */
+#ifdef RC_COMPACT
+typedef Customer* CustomerRef;
+#else
+typedef std::shared_ptr<Customer> CustomerRef;
+#endif
 
 class RecordsCompany {
   private:
-    HashTable<int, std::shared_ptr<Customer>> m_customers;
-    Tree<int, std::shared_ptr<Customer>> m_clubMembers;
-    int* m_records;
+    HashTable<int, CustomerRef> m_customers;
+    Tree<int, CustomerRef, PrizeAugment> m_clubMembers;
+#ifdef RC_COMPACT
+    CustomerPool m_customerPool;
+#endif
+    //every customer id by phone, the key is all there is to it
+    HashTable<PhoneKey, NoValue> m_phones;
+    //off unless setCustomerCache, serves findCustomer
+    CustomerCache m_customerCache;
+    SalesRanking m_records;
     UnionFind m_recordsUF;
     int m_numberOfRecords;
+#ifdef RC_STATS
+    Histogram m_latency[STAT_OP_COUNT];
+#endif
+    std::future<bool> m_pendingSnapshot;
+    WriteAheadLog m_log;
+    //generation of the log the current state continues
+    uint32_t m_logGeneration;
+    //log bytes the current state covers while the log is closed
+    long long m_logOffset;
+    ArchiveMode m_archiveMode;
+    std::string m_archiveDirectory;
+    //the sealed months in memory mode, oldest first
+    std::vector<std::shared_ptr<const MonthArchive>> m_archives;
+    //months written to m_archiveDirectory, including the ones there before
+    int m_diskMonths;
+    //a newMonth ran, so the next one has a month to seal
+    bool m_monthOpen;
+    //recover is applying the log, whose months were sealed before they were logged
+    bool m_replaying;
+    StatusType m_archiveStatus;
+    void serialize(SnapshotWriter& writer);
+    void clearCustomers();
+    CustomerRef newCustomer(int phone);
+    //gives back a customer no table holds, nullptr is ignored
+    void releaseCustomer(const CustomerRef& customer);
+    //borrowed from the customer table, no reference count traffic, through the customer cache when it's on
+    Customer* findCustomer(int c_id);
+    static const int LOOKUP_CHUNK = 64;
+    //findCustomer of up to LOOKUP_CHUNK ids with prefetching, nullptr for a negative id
+    void findCustomers(const int* c_ids, int count, Customer** customers);
+    void applyLogged(Command& command);
+    //archives the month newMonth is about to close
+    StatusType sealMonth();
+    std::string archivePath(int month) const;
 
   public:
     RecordsCompany();
     ~RecordsCompany();
     StatusType newMonth(int *records_stocks, int number_of_records);
+    StatusType addRecords(int *records_stocks, int number_of_records);
     StatusType addCostumer(int c_id, int phone);
     Output_t<int> getPhone(int c_id);
     StatusType makeMember(int c_id);
     Output_t<bool> isMember(int c_id);
+    /*
+     * Removal in O(log n). Revoking a membership drops the member's expenses and prizes, removing a
+     * customer revokes the membership first. The other members keep their prizes.
+     */
+    StatusType revokeMembership(int c_id);
+    StatusType removeCustomer(int c_id);
+    //the customer with this phone, the lowest id if several customers share it
+    Output_t<int> getCustomerByPhone(int phone);
+    //every customer with this phone, by id
+    StatusType getCustomersByPhone(int phone, std::vector<int> *customers);
+    /*
+     * getPhone / isMember of count customers at once, statuses[i] and phones[i] / members[i] being
+     * what the single call returns. The lookups are interleaved to overlap their cache misses.
+     */
+    StatusType getPhoneBatch(const int* c_ids, int count, int* phones, StatusType* statuses);
+    StatusType isMemberBatch(const int* c_ids, int count, bool* members, StatusType* statuses);
     StatusType buyRecord(int c_id, int r_id);
+    /*
+     * amount is rounded to cents, and like every other path it's INVALID_INPUT unless that's at least one cent.
+     * Amounts from MAX_MONEY_AMOUNT up are clamped to it; the sum of the prizes isn't checked for overflow.
+     */
     StatusType addPrize(int c_id1, int c_id2, double  amount);
     Output_t<double> getExpenses(int c_id);
+    //the same in exact cents, the driver, logs and protocol all come through here
+    StatusType addPrizeCents(int c_id1, int c_id2, Money amount);
+    Output_t<Money> getExpensesCents(int c_id);
     StatusType putOnTop(int r_id1, int r_id2);
+    /*
+     * putOnTop of count pairs on threads threads, statuses[i] being what putOnTop(r_id1s[i], r_id2s[i]) returns
+     * when the pairs touch disjoint stacks; overlapping pairs are applied in some order. The stacks are copied
+     * in and out in O(number of records), so it is meant for large batches. Runs sequentially while checkpoints exist.
+     */
+    StatusType putOnTopBatch(const int* r_id1s, const int* r_id2s, int count, int threads, StatusType* statuses);
     StatusType getPlace(int r_id, int *column, int *hight);
+    StatusType getColumn(int r_id, std::vector<int> *records);
+    Output_t<int> checkpoint();
+    StatusType rollbackTo(int checkpoint);
+    StatusType releaseCheckpoints();
+    StatusType topSellers(int k, std::vector<int> *records);
+    //the k members with the largest getExpenses, largest first
+    StatusType topSpenders(int k, std::vector<int> *members);
+    CompanyStats stats();
+    MemoryUsage memoryUsage() const;
+    /*
+     * A direct-mapped cache of about entries hot customers in front of the customer table for
+     * getPhone, isMember and buyRecord, 0 turns it off. Its hits and misses are in stats().
+     */
+    StatusType setCustomerCache(int entries);
+    /*
+     * Snapshots hold customers, members with their prizes, sale counters and stacks.
+     * The async save copies the state into memory and writes it from a background thread.
+     */
+    StatusType saveSnapshot(const std::string& path);
+    StatusType saveSnapshotAsync(const std::string& path);
+    StatusType waitForSnapshot();
+    StatusType loadSnapshot(const std::string& path);
+    /*
+     * Write-ahead log of every successful mutation. Operations still succeed if the log can't be
+     * written, the error is reported by the next commitLog / disableLog.
+     */
+    StatusType enableLog(const std::string& path, Durability durability, int groupSize);
+    StatusType disableLog();
+    StatusType commitLog();
+    //snapshot then truncate the log
+    StatusType compactLog(const std::string& snapshotPath);
+    //must run before enableLog
+    StatusType recover(const std::string& snapshotPath, const std::string& logPath);
+    /*
+     * With archiving on, newMonth first seals the month it closes, if one is open: the members' expenses and
+     * the records' sales go into a MonthArchive kept in memory, or written to directory/month-<n>.rca with
+     * n counting on from the files already there. Months are numbered in the order they closed. Archives
+     * are not part of snapshots. Replaying a log archives its months again in memory mode, while in disk
+     * mode their files were written before the log records, so recover doesn't write them again.
+     */
+    StatusType setArchiving(ArchiveMode mode, const std::string& directory = "");
+    int archivedMonths() const;
+    //how sealing went in the last newMonth, which closes the month either way; SUCCESS if nothing was sealed
+    StatusType lastArchiveStatus() const;
+    //reads the file back in disk mode
+    StatusType getArchive(int month, std::shared_ptr<const MonthArchive>* archive);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "Protocol.h"
+#include "../CommandLog.h"
+#include <cstring>
+
+void encodeResult(const CommandResult& result, std::vector<uint8_t>* output)
+{
+    output->push_back((uint8_t) result.m_op);
+    output->push_back((uint8_t) result.m_kind);
+    output->push_back((uint8_t) result.m_status);
+    switch (result.m_kind) {
+        case RESULT_INT:
+            appendVarint(result.m_int, output);
+            break;
+        case RESULT_BOOL:
+            output->push_back(result.m_bool ? 1 : 0);
+            break;
+        case RESULT_DOUBLE: {
+            const uint8_t* value = reinterpret_cast<const uint8_t*>(&result.m_double);
+            output->insert(output->end(), value, value + sizeof(double));
+            break;
+        }
+        case RESULT_PLACE:
+            appendVarint(result.m_int, output);
+            appendVarint(result.m_height, output);
+            break;
+        case RESULT_TEXT:
+        case RESULT_UNKNOWN:
+            appendVarint(result.m_word.size(), output);
+            output->insert(output->end(), result.m_word.begin(), result.m_word.end());
+            break;
+        case RESULT_STATUS:
+            break;
+    }
+}
+
+int decodeResult(const uint8_t* data, int size, CommandResult* result)
+{
+    if (size < 3)
+        return 0;
+    if (data[0] > OP_UNKNOWN || data[1] > RESULT_UNKNOWN || data[2] > DOESNT_EXISTS)
+        return -1;
+
+    result->m_op = (OpCode) data[0];
+    result->m_kind = (ResultKind) data[1];
+    result->m_status = (StatusType) data[2];
+    int position = 3;
+    int res = 1;
+    switch (result->m_kind) {
+        case RESULT_INT:
+            res = parseVarint(data, size, &position, &result->m_int);
+            break;
+        case RESULT_BOOL:
+            if (position == size)
+                return 0;
+            result->m_bool = data[position++] != 0;
+            break;
+        case RESULT_DOUBLE:
+            if (size - position < (int) sizeof(double))
+                return 0;
+            memcpy(&result->m_double, data + position, sizeof(double));
+            position += sizeof(double);
+            break;
+        case RESULT_PLACE:
+            res = parseVarint(data, size, &position, &result->m_int);
+            if (res == 1)
+                res = parseVarint(data, size, &position, &result->m_height);
+            break;
+        case RESULT_TEXT:
+        case RESULT_UNKNOWN: {
+            int length;
+            res = parseVarint(data, size, &position, &length);
+            if (res != 1)
+                break;
+            if (length < 0)
+                return -1;
+            if (length > size - position)
+                return 0;
+            result->m_word.assign(reinterpret_cast<const char*>(data + position), length);
+            position += length;
+            break;
+        }
+        case RESULT_STATUS:
+            break;
+    }
+    return res == 1 ? position : res;
+}
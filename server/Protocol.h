@@ -0,0 +1,20 @@
+#ifndef WET2_PROTOCOL_H
+#define WET2_PROTOCOL_H
+
+#include "../CommandExecutor.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * Wire format of the server. Requests are commands in the binary command log encoding,
+ * sent back to back without waiting for replies. Every request gets one reply, in order:
+ * the opcode, result kind and status bytes followed by the kind's payload.
+ * A malformed or oversized request gets an unknown command reply with INVALID_INPUT and the error
+ * as its word, and the server closes the connection after it.
+ */
+void encodeResult(const CommandResult& result, std::vector<uint8_t>* output);
+//returns the bytes the reply took, 0 if the buffer ends in the middle of it and -1 if it's malformed
+int decodeResult(const uint8_t* data, int size, CommandResult* result);
+
+
+#endif //WET2_PROTOCOL_H
@@ -0,0 +1,235 @@
+#include "Server.h"
+#include "Protocol.h"
+#include "../CommandLog.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+Server::Server(RecordsCompany* company, bool logging) : m_company(company), m_logging(logging), m_listener(-1),
+                                                        m_epoll(-1), m_readBuffer(READ_SIZE)
+{}
+
+Server::~Server()
+{
+    for (Connection* connection : m_connections) {
+        if (connection != nullptr) {
+            ::close(connection->m_fd);
+            delete connection;
+        }
+    }
+    if (m_epoll >= 0)
+        ::close(m_epoll);
+    if (m_listener >= 0) {
+        ::close(m_listener);
+        unlink(m_path.c_str());
+    }
+}
+
+bool Server::listen(const std::string& path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    m_listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listener < 0)
+        return false;
+    unlink(path.c_str());
+    if (bind(m_listener, (sockaddr*) &address, sizeof(address)) != 0 || ::listen(m_listener, SOMAXCONN) != 0) {
+        ::close(m_listener);
+        m_listener = -1;
+        return false;
+    }
+    m_path = path;
+
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll < 0)
+        return false;
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    return epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listener, &event) == 0;
+}
+
+bool Server::run(const volatile sig_atomic_t* stopped)
+{
+    epoll_event events[MAX_EVENTS];
+    while (!*stopped) {
+        int count = epoll_wait(m_epoll, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            Connection* connection = (Connection*) events[i].data.ptr;
+            if (connection == nullptr) {
+                accept();
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                receive(connection);
+            touch(connection);
+        }
+
+        //group commit: one sync covers every mutation of the batch, and no reply leaves before it
+        if (m_logging && m_company->commitLog() != SUCCESS) {
+            fprintf(stderr, "server: write-ahead log commit failed\n");
+            return false;
+        }
+        for (Connection* connection : m_touched) {
+            connection->m_touched = false;
+            if (!send(connection) || (connection->m_closing && connection->m_written == connection->m_output.size()))
+                close(connection);
+            else
+                updateEvents(connection);
+        }
+        m_touched.clear();
+    }
+    return true;
+}
+
+void Server::accept()
+{
+    while (true) {
+        int fd = accept4(m_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        Connection* connection;
+        try {
+            connection = new Connection(fd);
+            if ((size_t) fd >= m_connections.size())
+                m_connections.resize(fd + 1, nullptr);
+        } catch (std::bad_alloc& e) {
+            ::close(fd);
+            continue;
+        }
+        m_connections[fd] = connection;
+        connection->m_events = EPOLLIN;
+        epoll_event event;
+        event.events = connection->m_events;
+        event.data.ptr = connection;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+            close(connection);
+    }
+}
+
+void Server::receive(Connection* connection)
+{
+    while (!connection->m_closing && connection->m_input.size() < MAX_INPUT) {
+        ssize_t received = read(connection->m_fd, m_readBuffer.data(), READ_SIZE);
+        if (received > 0) {
+            connection->m_input.insert(connection->m_input.end(), m_readBuffer.begin(), m_readBuffer.begin() + received);
+            continue;
+        }
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            connection->m_closing = true;
+        break;
+    }
+    execute(connection);
+}
+
+//executes every complete request, a partial one waits for the rest of its bytes
+void Server::execute(Connection* connection)
+{
+    const uint8_t* data = connection->m_input.data();
+    int size = connection->m_input.size();
+    int position = 0;
+    while (true) {
+        int length = decodeCommand(data + position, size - position, &m_command);
+        if (length < 0) {
+            rejectInput(connection, "malformed request");
+            position = size;
+            break;
+        }
+        if (length == 0)
+            break;
+        position += length;
+        executeCommand(m_company, m_command, &m_result);
+        encodeResult(m_result, &connection->m_output);
+    }
+    connection->m_input.erase(connection->m_input.begin(), connection->m_input.begin() + position);
+    //receive stops reading at MAX_INPUT, so a request that big can never complete
+    if (connection->m_input.size() >= MAX_INPUT) {
+        rejectInput(connection, "request too large");
+        connection->m_input.clear();
+    }
+}
+
+//replies with an unknown command carrying the error, then closes once the replies are out
+void Server::rejectInput(Connection* connection, const char* error)
+{
+    m_result.m_op = OP_UNKNOWN;
+    m_result.m_kind = RESULT_UNKNOWN;
+    m_result.m_status = INVALID_INPUT;
+    m_result.m_word = error;
+    encodeResult(m_result, &connection->m_output);
+    connection->m_closing = true;
+}
+
+//writes what the socket takes, false if the peer is gone
+bool Server::send(Connection* connection)
+{
+    std::vector<uint8_t>& output = connection->m_output;
+    while (connection->m_written < output.size()) {
+        ssize_t sent = ::send(connection->m_fd, output.data() + connection->m_written,
+                              output.size() - connection->m_written, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection->m_written += sent;
+    }
+    output.clear();
+    connection->m_written = 0;
+    return true;
+}
+
+void Server::updateEvents(Connection* connection)
+{
+    size_t pending = connection->m_output.size() - connection->m_written;
+    uint32_t events = 0;
+    if (pending > 0)
+        events |= EPOLLOUT;
+    if (pending < MAX_OUTPUT && !connection->m_closing)
+        events |= EPOLLIN;
+    if (events == connection->m_events)
+        return;
+
+    connection->m_events = events;
+    epoll_event event;
+    event.events = events;
+    event.data.ptr = connection;
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, connection->m_fd, &event);
+}
+
+void Server::close(Connection* connection)
+{
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, connection->m_fd, nullptr);
+    ::close(connection->m_fd);
+    m_connections[connection->m_fd] = nullptr;
+    delete connection;
+}
+
+void Server::touch(Connection* connection)
+{
+    if (connection->m_touched)
+        return;
+    connection->m_touched = true;
+    m_touched.push_back(connection);
+}
@@ -0,0 +1,73 @@
+#ifndef WET2_SERVER_H
+#define WET2_SERVER_H
+
+#include "../recordsCompany.h"
+#include "../CommandExecutor.h"
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Connection {
+public:
+    explicit Connection(int fd) : m_fd(fd), m_written(0), m_events(0), m_closing(false), m_touched(false) {}
+    int m_fd;
+    //received bytes not decoded yet, may end in the middle of a request
+    std::vector<uint8_t> m_input;
+    std::vector<uint8_t> m_output;
+    size_t m_written;
+    //epoll events the connection is registered for
+    uint32_t m_events;
+    //the peer hung up or sent a malformed request, close once the replies are out
+    bool m_closing;
+    //already in this wakeup's list of connections to flush
+    bool m_touched;
+};
+
+/*
+ * Serves one RecordsCompany over a Unix domain socket with a single-threaded epoll loop.
+ * Every wakeup reads all the ready connections and executes each complete request in order,
+ * then commits the write-ahead log once for the whole batch before any reply is sent.
+ */
+class Server {
+public:
+    //logging tells the server to commit the company's log before replying
+    Server(RecordsCompany* company, bool logging);
+    ~Server();
+    Server(const Server& other) = delete;
+    Server& operator=(const Server& other) = delete;
+    //replaces a stale socket file at path, false on failure with errno set
+    bool listen(const std::string& path);
+    //serves until *stopped is set, false on an epoll or log error
+    bool run(const volatile sig_atomic_t* stopped);
+private:
+    static const int MAX_EVENTS = 256;
+    static const int READ_SIZE = 1 << 16;
+    //a request that doesn't fit is malformed
+    static const size_t MAX_INPUT = 1 << 24;
+    //stop reading from a client that doesn't read its replies
+    static const size_t MAX_OUTPUT = 1 << 24;
+    RecordsCompany* m_company;
+    bool m_logging;
+    int m_listener;
+    int m_epoll;
+    std::string m_path;
+    //indexed by fd
+    std::vector<Connection*> m_connections;
+    std::vector<Connection*> m_touched;
+    std::vector<uint8_t> m_readBuffer;
+    Command m_command;
+    CommandResult m_result;
+
+    void accept();
+    void receive(Connection* connection);
+    void execute(Connection* connection);
+    void rejectInput(Connection* connection, const char* error);
+    bool send(Connection* connection);
+    void updateEvents(Connection* connection);
+    void close(Connection* connection);
+    void touch(Connection* connection);
+};
+
+
+#endif //WET2_SERVER_H
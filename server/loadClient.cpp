@@ -0,0 +1,251 @@
+#include "Protocol.h"
+#include "../CommandLog.h"
+#include "../bench/WorkloadGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Load generator for the server: runs the benchmark workload over several connections,
+ * each keeping up to depth requests in flight, and reports throughput and reply latency.
+ * Usage: loadClient <socket> [connections=N] [depth=N] [workload options of bench/benchmark]
+ *        loadClient <socket> --text <file>    runs a driver command file and prints the replies like the driver
+ * Build (from the repository root):
+ *   g++ -std=c++11 -O2 -DNDEBUG -pthread server/loadClient.cpp server/Protocol.cpp bench/WorkloadGenerator.cpp \
+ *       $(ls *.cpp | grep -v mainWet2) -o loadClient
+ */
+
+typedef chrono::steady_clock Clock;
+
+static long long nanoseconds(Clock::time_point from, Clock::time_point to)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(to - from).count();
+}
+
+static int connectTo(const char* path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+/*
+ * Sends the commands keeping up to depth of them unanswered. Calls reply(index, result)
+ * for every reply in order, latencies gets the time from sending each request to its reply.
+ */
+template <class Reply>
+static bool runCommands(int fd, const vector<Command>& commands, int depth, vector<long long>* latencies,
+                        Reply reply)
+{
+    vector<uint8_t> requests;
+    vector<size_t> offsets;
+    for (const Command& command : commands) {
+        offsets.push_back(requests.size());
+        encodeCommand(command, &requests);
+    }
+    offsets.push_back(requests.size());
+
+    vector<Clock::time_point> sentAt(commands.size());
+    vector<uint8_t> input(1 << 16);
+    size_t inputSize = 0;
+    size_t sent = 0, answered = 0;
+    CommandResult result;
+    while (answered < commands.size()) {
+        size_t batchEnd = min(commands.size(), answered + depth);
+        if (sent < batchEnd) {
+            Clock::time_point now = Clock::now();
+            fill(sentAt.begin() + sent, sentAt.begin() + batchEnd, now);
+            if (!writeAll(fd, requests.data() + offsets[sent], offsets[batchEnd] - offsets[sent]))
+                return false;
+            sent = batchEnd;
+        }
+
+        if (inputSize == input.size())
+            input.resize(2 * input.size());
+        ssize_t received = recv(fd, input.data() + inputSize, input.size() - inputSize, 0);
+        if (received <= 0)
+            return false;
+        inputSize += received;
+        Clock::time_point now = Clock::now();
+        size_t position = 0;
+        int length;
+        while ((length = decodeResult(input.data() + position, inputSize - position, &result)) > 0) {
+            if (latencies != nullptr)
+                latencies->push_back(nanoseconds(sentAt[answered], now));
+            reply(answered, result);
+            position += length;
+            answered++;
+        }
+        if (length < 0)
+            return false;
+        memmove(input.data(), input.data() + position, inputSize - position);
+        inputSize -= position;
+    }
+    return true;
+}
+
+static int runText(const char* socketPath, const char* path)
+{
+    FILE* text = fopen(path, "r");
+    if (text == nullptr)
+        return -1;
+    vector<Command> commands;
+    bool stoppedEarly = false;
+    {
+        CommandScanner scanner(text);
+        Command command;
+        while (scanner.next(&command)) {
+            if (command.m_op == OP_UNKNOWN || scanner.failed()) {
+                stoppedEarly = true;
+                break;
+            }
+            commands.push_back(command);
+        }
+    }
+    fclose(text);
+
+    int fd = connectTo(socketPath);
+    if (fd < 0)
+        return -1;
+    OutputWriter out(stdout);
+    bool ok = runCommands(fd, commands, 4096, nullptr, [&out](size_t, const CommandResult& result) {
+        printResult(out, result);
+    });
+    close(fd);
+    return ok && !stoppedEarly ? 0 : -1;
+}
+
+static void report(const char* name, vector<long long>& latencies)
+{
+    if (latencies.empty())
+        return;
+    sort(latencies.begin(), latencies.end());
+    printf("%-12s %10zu %8lld %8lld %8lld %8lld %8lld\n", name, latencies.size(), latencies[latencies.size() / 2],
+           latencies[(size_t) (0.9 * (latencies.size() - 1))], latencies[(size_t) (0.99 * (latencies.size() - 1))],
+           latencies[(size_t) (0.999 * (latencies.size() - 1))], latencies.back());
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: loadClient <socket> [connections=N] [depth=N] [workload options]\n"
+                        "       loadClient <socket> --text <file>\n");
+        return -1;
+    }
+    if (argc == 4 && !string(argv[2]).compare("--text"))
+        return runText(argv[1], argv[3]);
+
+    WorkloadConfig config;
+    int connections = 4, depth = 64;
+    for (int i = 2; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument.compare(0, 12, "connections=") == 0) {
+            connections = atoi(argument.c_str() + 12);
+        } else if (argument.compare(0, 6, "depth=") == 0) {
+            depth = atoi(argument.c_str() + 6);
+        } else if (!config.parse(argument)) {
+            fprintf(stderr, "bad argument: %s\n", argv[i]);
+            return -1;
+        }
+    }
+    if (connections < 1 || depth < 1) {
+        fprintf(stderr, "connections and depth must be positive\n");
+        return -1;
+    }
+
+    WorkloadGenerator generator(config);
+    vector<Command> setup, workload;
+    generator.setup(&setup);
+    generator.generate(&workload);
+
+    int fd = connectTo(argv[1]);
+    if (fd < 0) {
+        fprintf(stderr, "can't connect to %s\n", argv[1]);
+        return -1;
+    }
+    Clock::time_point start = Clock::now();
+    bool ok = runCommands(fd, setup, 4096, nullptr, [](size_t, const CommandResult&) {});
+    close(fd);
+    if (!ok) {
+        fprintf(stderr, "setup failed\n");
+        return -1;
+    }
+    printf("setup: %zu commands in %.3f s\n", setup.size(), nanoseconds(start, Clock::now()) / 1e9);
+
+    //every connection runs an interleaved share of the workload
+    vector<vector<Command>> shares(connections);
+    for (size_t i = 0; i < workload.size(); ++i) {
+        shares[i % connections].push_back(workload[i]);
+    }
+    vector<vector<vector<long long>>> latencies(connections, vector<vector<long long>>(OP_UNKNOWN));
+    vector<char> failed(connections, 0);
+    vector<thread> threads;
+    start = Clock::now();
+    for (int c = 0; c < connections; ++c) {
+        threads.emplace_back([&, c]() {
+            int connection = connectTo(argv[1]);
+            vector<long long> all;
+            const vector<Command>& share = shares[c];
+            failed[c] = connection < 0 || !runCommands(connection, share, depth, &all, [](size_t, const CommandResult&) {});
+            for (size_t i = 0; i < all.size(); ++i) {
+                latencies[c][share[i].m_op].push_back(all[i]);
+            }
+            if (connection >= 0)
+                close(connection);
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    long long total = nanoseconds(start, Clock::now());
+    for (int c = 0; c < connections; ++c) {
+        if (failed[c]) {
+            fprintf(stderr, "connection %d failed\n", c);
+            return -1;
+        }
+    }
+
+    printf("run: %zu commands over %d connections, depth %d, in %.3f s, %.0f ops/s\n", workload.size(), connections,
+           depth, total / 1e9, workload.size() * 1e9 / (total > 0 ? total : 1));
+    printf("%-12s %10s %8s %8s %8s %8s %8s\n", "op", "count", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns");
+    vector<long long> all;
+    for (int op = 0; op < OP_UNKNOWN; ++op) {
+        vector<long long> merged;
+        for (int c = 0; c < connections; ++c) {
+            merged.insert(merged.end(), latencies[c][op].begin(), latencies[c][op].end());
+        }
+        all.insert(all.end(), merged.begin(), merged.end());
+        report(opCodeName((OpCode) op), merged);
+    }
+    report("all", all);
+    return 0;
+}
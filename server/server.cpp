@@ -0,0 +1,92 @@
+#include "Server.h"
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+/*
+ * Serves the driver's command set over a Unix domain socket, see Protocol.h for the wire format.
+ * Usage: server <socket> [--log <path> --snapshot <path>] [--durability none|batch|sync]
+ * With a log the server recovers from the snapshot and log on start, logs every mutation,
+ * and compacts the log into the snapshot on SIGINT / SIGTERM.
+ * Build (from the repository root):
+ *   g++ -std=c++11 -O2 -DNDEBUG -pthread server/server.cpp server/Server.cpp server/Protocol.cpp \
+ *       $(ls *.cpp | grep -v mainWet2) -o server
+ */
+
+static volatile sig_atomic_t stopped = 0;
+
+static void stop(int)
+{
+    stopped = 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: server <socket> [--log <path> --snapshot <path>] [--durability none|batch|sync]\n");
+        return -1;
+    }
+    string logPath, snapshotPath;
+    Durability durability = DURABILITY_GROUP;
+    int groupSize = INT_MAX;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string option = argv[i], value = argv[i + 1];
+        if (option == "--log") {
+            logPath = value;
+        } else if (option == "--snapshot") {
+            snapshotPath = value;
+        } else if (option == "--durability" && value == "none") {
+            durability = DURABILITY_NONE;
+        } else if (option == "--durability" && value == "batch") {
+            //the server commits once per batch, the log itself never syncs on its own
+            durability = DURABILITY_GROUP;
+            groupSize = INT_MAX;
+        } else if (option == "--durability" && value == "sync") {
+            durability = DURABILITY_SYNC;
+            groupSize = 1;
+        } else {
+            fprintf(stderr, "bad argument: %s %s\n", option.c_str(), value.c_str());
+            return -1;
+        }
+    }
+    if (argc % 2 != 0 || logPath.empty() != snapshotPath.empty()) {
+        fprintf(stderr, "--log and --snapshot go together\n");
+        return -1;
+    }
+
+    RecordsCompany* company = new RecordsCompany();
+    bool logging = !logPath.empty();
+    if (logging && (company->recover(snapshotPath, logPath) != SUCCESS ||
+                    company->enableLog(logPath, durability, groupSize) != SUCCESS)) {
+        fprintf(stderr, "server: can't recover from %s and %s\n", snapshotPath.c_str(), logPath.c_str());
+        delete company;
+        return -1;
+    }
+
+    int res = 0;
+    {
+        Server server(company, logging);
+        if (!server.listen(argv[1])) {
+            fprintf(stderr, "server: can't listen on %s: %s\n", argv[1], strerror(errno));
+            res = -1;
+        } else {
+            signal(SIGINT, stop);
+            signal(SIGTERM, stop);
+            signal(SIGPIPE, SIG_IGN);
+            if (!server.run(&stopped))
+                res = -1;
+        }
+    }
+
+    if (logging && company->compactLog(snapshotPath) != SUCCESS) {
+        fprintf(stderr, "server: can't write the snapshot %s\n", snapshotPath.c_str());
+        res = -1;
+    }
+    delete company;
+    return res;
+}